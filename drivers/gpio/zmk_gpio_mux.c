@@ -16,15 +16,76 @@ struct zgm_config {
 
     struct gpio_dt_spec en_gpio;
     struct gpio_dt_spec out_gpio;
+    // One enable line per cascaded mux chip, selected by the channel bits above the select lines.
+    const struct gpio_dt_spec *chip_gpios;
+    uint8_t chip_gpios_len;
     uint8_t sel_gpios_len;
     struct gpio_dt_spec sel_gpios[];
 };
 
+// Select and chip enable lines sharing one GPIO port, written together with a single masked port
+// write.
+struct zgm_port_group {
+    const struct device *port;
+    // Bits of the channel number driven by the select lines of this group.
+    uint32_t channel_bits;
+    gpio_port_pins_t pins;
+    gpio_port_pins_t active_low;
+};
+
 struct zgm_data {
     struct gpio_driver_data common;
     gpio_pin_t active_pin;
+    // Channel the select lines currently point at, or -1 if unknown after a failed write.
+    int16_t selected;
+    uint8_t groups_len;
+    struct zgm_port_group *groups;
 };
 
+static int zgm_select(const struct device *dev, gpio_pin_t pin) {
+    const struct zgm_config *cfg = dev->config;
+    struct zgm_data *data = dev->data;
+
+    if (data->selected == pin) {
+        return 0;
+    }
+
+    uint32_t changed = data->selected < 0 ? UINT32_MAX : (uint32_t)(data->selected ^ pin);
+
+    for (int g = 0; g < data->groups_len; g++) {
+        const struct zgm_port_group *group = &data->groups[g];
+
+        if ((changed & group->channel_bits) == 0) {
+            continue;
+        }
+
+        gpio_port_value_t value = 0;
+
+        for (int i = 0; i < cfg->sel_gpios_len; i++) {
+            if (cfg->sel_gpios[i].port == group->port && (pin & BIT(i))) {
+                value |= BIT(cfg->sel_gpios[i].pin);
+            }
+        }
+
+        for (int i = 0; i < cfg->chip_gpios_len; i++) {
+            if (cfg->chip_gpios[i].port == group->port && (pin >> cfg->sel_gpios_len) == i) {
+                value |= BIT(cfg->chip_gpios[i].pin);
+            }
+        }
+
+        int ret = gpio_port_set_masked_raw(group->port, group->pins, value ^ group->active_low);
+        if (ret < 0) {
+            LOG_ERR("Failed to set the select-gpios (%d)", ret);
+            data->selected = -1;
+            return ret;
+        }
+    }
+
+    data->selected = pin;
+
+    return 0;
+}
+
 static int zgm_pin_config(const struct device *dev, gpio_pin_t pin, gpio_flags_t flags) {
     int ret = 0;
     const struct zgm_config *cfg = dev->config;
@@ -33,12 +94,13 @@ static int zgm_pin_config(const struct device *dev, gpio_pin_t pin, gpio_flags_t
     if (flags & GPIO_OUTPUT) {
         return -ENOTSUP;
     } else if (flags & GPIO_INPUT) {
-        data->active_pin = pin;
-        for (int i = 0; i < cfg->sel_gpios_len; i++) {
-            int val = (pin & BIT(i)) != 0 ? 1 : 0;
-            gpio_pin_set_dt(&cfg->sel_gpios[i], val);
+        ret = zgm_select(dev, pin);
+        if (ret < 0) {
+            return ret;
         }
 
+        data->active_pin = pin;
+
         if (cfg->en_gpio.port) {
             ret = gpio_pin_set_dt(&cfg->en_gpio, 1);
         }
@@ -56,17 +118,75 @@ static int zgm_pin_config(const struct device *dev, gpio_pin_t pin, gpio_flags_t
     return ret;
 }
 
+// Only the selected channel is connected to out-gpios, every other pin reads low.
+static int zgm_port_get_raw(const struct device *dev, gpio_port_value_t *value) {
+    const struct zgm_config *cfg = dev->config;
+    struct zgm_data *data = dev->data;
 
+    if (!cfg->out_gpio.port) {
+        return -ENOTSUP;
+    }
+
+    *value = 0;
+    if (data->active_pin == (gpio_pin_t)-1) {
+        return 0;
+    }
+
+    int ret = gpio_pin_get_dt(&cfg->out_gpio);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (ret) {
+        *value = BIT(data->active_pin);
+    }
+
+    return 0;
+}
+
+// The mux only routes inputs, so none of its pins can be written.
+static int zgm_port_set_masked_raw(const struct device *dev, gpio_port_pins_t mask,
+                                   gpio_port_value_t value) {
+    return -ENOTSUP;
+}
+
+static int zgm_port_write_pins(const struct device *dev, gpio_port_pins_t pins) {
+    return -ENOTSUP;
+}
 
 static const struct gpio_driver_api api_table = {
     .pin_configure = zgm_pin_config,
-    // .port_get_raw = zgm_port_get_raw,
-    // .port_set_masked_raw = zgm_port_set_masked_raw,
-    // .port_set_bits_raw = zgm_port_set_bits_raw,
-    // .port_clear_bits_raw = zgm_port_clear_bits_raw,
-    // .port_toggle_bits = zgm_port_toggle_bits,
+    .port_get_raw = zgm_port_get_raw,
+    .port_set_masked_raw = zgm_port_set_masked_raw,
+    .port_set_bits_raw = zgm_port_write_pins,
+    .port_clear_bits_raw = zgm_port_write_pins,
+    .port_toggle_bits = zgm_port_write_pins,
 };
 
+// Group of the select lines on a port, added on first use.
+static struct zgm_port_group *zgm_port_group(struct zgm_data *data, const struct device *port) {
+    int g = 0;
+    while (g < data->groups_len && data->groups[g].port != port) {
+        g++;
+    }
+
+    if (g == data->groups_len) {
+        data->groups[g] = (struct zgm_port_group){.port = port};
+        data->groups_len++;
+    }
+
+    return &data->groups[g];
+}
+
+static void zgm_port_group_add(struct zgm_port_group *group, const struct gpio_dt_spec *spec,
+                               uint32_t channel_bits) {
+    group->channel_bits |= channel_bits;
+    group->pins |= BIT(spec->pin);
+    if (spec->dt_flags & GPIO_ACTIVE_LOW) {
+        group->active_low |= BIT(spec->pin);
+    }
+}
+
 /**
  * @brief Initialization function of 595
  *
@@ -75,6 +195,7 @@ static const struct gpio_driver_api api_table = {
  */
 static int zgm_init(const struct device *dev) {
     const struct zgm_config *cfg = dev->config;
+    struct zgm_data *data = dev->data;
 
     if (cfg->en_gpio.port != NULL) {
         if (!device_is_ready(cfg->en_gpio.port)) {
@@ -92,20 +213,53 @@ static int zgm_init(const struct device *dev) {
         }
 
         gpio_pin_configure_dt(&cfg->sel_gpios[i], GPIO_OUTPUT_INACTIVE);
+
+        zgm_port_group_add(zgm_port_group(data, cfg->sel_gpios[i].port), &cfg->sel_gpios[i],
+                           BIT(i));
     }
 
+    for (int i = 0; i < cfg->chip_gpios_len; i++) {
+        if (!device_is_ready(cfg->chip_gpios[i].port)) {
+            LOG_ERR("Chip enable port is not ready");
+            return -ENODEV;
+        }
+
+        gpio_pin_configure_dt(&cfg->chip_gpios[i], GPIO_OUTPUT_INACTIVE);
+
+        // Any change of the chip number moves the enable from one chip to another.
+        zgm_port_group_add(zgm_port_group(data, cfg->chip_gpios[i].port), &cfg->chip_gpios[i],
+                           ~BIT_MASK(cfg->sel_gpios_len));
+    }
+
+    // Every select line starts inactive, which selects channel 0, but no chip is enabled yet so a
+    // cascade has nothing selected until the first write.
+    data->selected = cfg->chip_gpios_len ? -1 : 0;
+    data->active_pin = -1;
+
     return 0;
 }
 
 #define GPIO_PORT_PIN_MASK_FROM_NGPIOS(ngpios) ((gpio_port_pins_t)(((uint64_t)1 << (ngpios)) - 1U))
 
-#define GPIO_PORT_PIN_MASK_FROM_DT_INST(inst)                                                      \
-    GPIO_PORT_PIN_MASK_FROM_NGPIOS((1 << DT_INST_PROP_LEN(inst, select_gpios)))
+#define ZGM_CHIPS(inst) DT_INST_PROP_LEN_OR(inst, chip_enable_gpios, 0)
+
+#define ZGM_CHANNELS(inst)                                                                         \
+    ((1 << DT_INST_PROP_LEN(inst, select_gpios)) * MAX(1, ZGM_CHIPS(inst)))
+
+#define GPIO_PORT_PIN_MASK_FROM_DT_INST(inst) GPIO_PORT_PIN_MASK_FROM_NGPIOS(ZGM_CHANNELS(inst))
 
 #define ZGM_GPIO_DT_SPEC_ELEM(n, prop, idx) \
     GPIO_DT_SPEC_GET_BY_IDX(n, prop, idx),
 
 #define ZGM_INIT(n)                                                                            \
+    BUILD_ASSERT(ZGM_CHANNELS(n) <= 32, "A mux instance is limited to 32 channels");             \
+                                                                                                   \
+    COND_CODE_1(DT_INST_NODE_HAS_PROP(n, chip_enable_gpios),                                       \
+                (static const struct gpio_dt_spec zgm_##n##_chip_gpios[] = {                       \
+                     DT_FOREACH_PROP_ELEM(DT_DRV_INST(n), chip_enable_gpios,                       \
+                                          ZGM_GPIO_DT_SPEC_ELEM)};),                               \
+                ())                                                                                \
+                                                                                                   \
     static struct zgm_config zgm_##n##_config = {                                          \
         .common =                                                                                  \
             {                                                                                      \
@@ -113,11 +267,19 @@ static int zgm_init(const struct device *dev) {
             },                                                                                     \
         .en_gpio = GPIO_DT_SPEC_INST_GET_OR(n, en_gpios, {}), \
         .out_gpio = GPIO_DT_SPEC_INST_GET_OR(n, out_gpios, {0}), \
+        .chip_gpios = COND_CODE_1(DT_INST_NODE_HAS_PROP(n, chip_enable_gpios),                     \
+                                  (zgm_##n##_chip_gpios), (NULL)),                                 \
+        .chip_gpios_len = ZGM_CHIPS(n), \
         .sel_gpios = {DT_FOREACH_PROP_ELEM(DT_DRV_INST(n), select_gpios, ZGM_GPIO_DT_SPEC_ELEM)}, \
         .sel_gpios_len = DT_INST_PROP_LEN(n, select_gpios), \
     };                                                                                             \
                                                                                                    \
-    static struct zgm_data zgm_##n##_data = {};                                     \
+    static struct zgm_port_group                                                                   \
+        zgm_##n##_groups[DT_INST_PROP_LEN(n, select_gpios) + ZGM_CHIPS(n)];                        \
+                                                                                                   \
+    static struct zgm_data zgm_##n##_data = {                                                      \
+        .groups = zgm_##n##_groups,                                                                \
+    };                                                                                             \
                                                                                                    \
     DEVICE_DT_INST_DEFINE(n, zgm_init, NULL, &zgm_##n##_data, &zgm_##n##_config,    \
                           POST_KERNEL, CONFIG_GPIO_INIT_PRIORITY, &api_table);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+// Rows of per-input key bits, one row per strobe. Rows are whole 64 bit words so a row of up to
+// 64 inputs stays a single word, and wider rows are still walked a word at a time by clearing
+// the lowest set bit of each word.
+
+#define EC_MATRIX_BITSET_WORD_BITS 64
+
+#define EC_MATRIX_BITSET_WORDS(bits) DIV_ROUND_UP(bits, EC_MATRIX_BITSET_WORD_BITS)
+
+static inline bool ec_matrix_bitset_test(const uint64_t *set, uint16_t bit) {
+    return (set[bit / EC_MATRIX_BITSET_WORD_BITS] & BIT64(bit % EC_MATRIX_BITSET_WORD_BITS)) != 0;
+}
+
+static inline void ec_matrix_bitset_set(uint64_t *set, uint16_t bit) {
+    set[bit / EC_MATRIX_BITSET_WORD_BITS] |= BIT64(bit % EC_MATRIX_BITSET_WORD_BITS);
+}
+
+static inline void ec_matrix_bitset_clear(uint64_t *set, uint16_t bit) {
+    set[bit / EC_MATRIX_BITSET_WORD_BITS] &= ~BIT64(bit % EC_MATRIX_BITSET_WORD_BITS);
+}
+
+static inline void ec_matrix_bitset_assign(uint64_t *set, uint16_t bit, bool val) {
+    if (val) {
+        ec_matrix_bitset_set(set, bit);
+    } else {
+        ec_matrix_bitset_clear(set, bit);
+    }
+}
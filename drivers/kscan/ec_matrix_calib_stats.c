@@ -0,0 +1,104 @@
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include "ec_matrix_calib_stats.h"
+
+void ec_matrix_calib_stats_reset(struct ec_matrix_calib_stats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_MEDIAN_FILTER)
+
+static inline uint16_t median3(uint16_t a, uint16_t b, uint16_t c) {
+    return MAX(MIN(a, b), MIN(MAX(a, b), c));
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_MEDIAN_FILTER)
+
+static uint32_t isqrt64(uint64_t val) {
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > val) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (val >= res + bit) {
+            val -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)res;
+}
+
+void ec_matrix_calib_stats_add(struct ec_matrix_calib_stats *stats, uint16_t val) {
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_MEDIAN_FILTER)
+    uint16_t raw = val;
+    // A single spike never ends up as the median of three consecutive samples.
+    bool primed = stats->seen >= 2;
+
+    if (primed) {
+        val = median3(raw, stats->window[0], stats->window[1]);
+    }
+
+    stats->window[1] = stats->window[0];
+    stats->window[0] = raw;
+    stats->seen++;
+
+    if (!primed) {
+        return;
+    }
+#else
+    stats->seen++;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_MEDIAN_FILTER)
+
+    int32_t x = (int32_t)val << EC_MATRIX_CALIB_STATS_MEAN_FRACTION_BITS;
+
+    if (stats->count == 0) {
+        stats->min = stats->max = val;
+        stats->mean = x;
+        stats->m2 = 0;
+        stats->count = 1;
+        return;
+    }
+
+    stats->min = MIN(stats->min, val);
+    stats->max = MAX(stats->max, val);
+    stats->count++;
+
+    int32_t delta = x - stats->mean;
+    stats->mean += delta / stats->count;
+    int32_t delta2 = x - stats->mean;
+
+    // Both deltas share their sign, rounding in the mean update aside.
+    int64_t product = (int64_t)delta * delta2;
+    if (product > 0) {
+        stats->m2 += product;
+    }
+}
+
+uint16_t ec_matrix_calib_stats_mean(const struct ec_matrix_calib_stats *stats) {
+    return (stats->mean + BIT(EC_MATRIX_CALIB_STATS_MEAN_FRACTION_BITS - 1)) >>
+           EC_MATRIX_CALIB_STATS_MEAN_FRACTION_BITS;
+}
+
+uint16_t ec_matrix_calib_stats_sigma(const struct ec_matrix_calib_stats *stats) {
+    if (stats->count < 2) {
+        return 0;
+    }
+
+    // The variance has twice the mean's fraction bits, so its root has the mean's.
+    uint32_t sigma = isqrt64(stats->m2 / (stats->count - 1));
+    uint8_t shift =
+        EC_MATRIX_CALIB_STATS_MEAN_FRACTION_BITS - EC_MATRIX_CALIB_STATS_SIGMA_FRACTION_BITS;
+
+    sigma = (sigma + BIT(shift - 1)) >> shift;
+
+    return MIN(sigma, UINT16_MAX);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+// Fraction bits of the running mean.
+#define EC_MATRIX_CALIB_STATS_MEAN_FRACTION_BITS 8
+// Fraction bits of the standard deviation reported by ec_matrix_calib_stats_sigma().
+#define EC_MATRIX_CALIB_STATS_SIGMA_FRACTION_BITS 4
+
+// Running statistics of the samples taken for one key, using Welford's algorithm in fixed point.
+struct ec_matrix_calib_stats {
+    // Mean of the accepted samples with EC_MATRIX_CALIB_STATS_MEAN_FRACTION_BITS fraction bits.
+    int32_t mean;
+    // Sum of squared differences from the mean, with twice as many fraction bits.
+    uint64_t m2;
+    uint16_t min;
+    uint16_t max;
+    // Previous raw samples, most recent first, for the median prefilter.
+    uint16_t window[2];
+    // Samples accepted into the statistics.
+    uint16_t count;
+    // Raw samples seen, including the ones only priming the median prefilter.
+    uint16_t seen;
+};
+
+void ec_matrix_calib_stats_reset(struct ec_matrix_calib_stats *stats);
+
+void ec_matrix_calib_stats_add(struct ec_matrix_calib_stats *stats, uint16_t val);
+
+uint16_t ec_matrix_calib_stats_mean(const struct ec_matrix_calib_stats *stats);
+
+// Sample standard deviation with EC_MATRIX_CALIB_STATS_SIGMA_FRACTION_BITS fraction bits.
+uint16_t ec_matrix_calib_stats_sigma(const struct ec_matrix_calib_stats *stats);
+
+static inline uint16_t ec_matrix_calib_stats_range(const struct ec_matrix_calib_stats *stats) {
+    return stats->max - stats->min;
+}
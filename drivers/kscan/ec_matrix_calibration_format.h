@@ -0,0 +1,31 @@
+#pragma once
+
+#include <zephyr/sys/crc.h>
+#include <zephyr/toolchain.h>
+
+#include "zmk_kscan_ec_matrix.h"
+
+// Version of the stored calibration layout, bumped whenever the header or the entries change.
+#define ZMK_KSCAN_EC_MATRIX_CALIBRATION_FORMAT_VERSION 1
+
+// Entries per stored chunk, the unit rewritten when any of its entries changes.
+#define ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES 16
+
+struct zmk_kscan_ec_matrix_calibration_header {
+    uint8_t version;
+    uint8_t strobes;
+    uint8_t inputs;
+    uint8_t chunk_entries;
+    // zmk_kscan_ec_matrix_calibration_crc() of all the entries.
+    uint32_t crc;
+} __packed;
+
+static inline size_t zmk_kscan_ec_matrix_calibration_chunks(size_t len) {
+    return DIV_ROUND_UP(len, ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES);
+}
+
+static inline uint32_t
+zmk_kscan_ec_matrix_calibration_crc(const struct zmk_kscan_ec_matrix_calibration_entry *entries,
+                                    size_t len) {
+    return crc32_ieee((const uint8_t *)entries, len * sizeof(entries[0]));
+}
@@ -1,7 +1,9 @@
 
 #include <sys/types.h>
+#include <zephyr/kernel.h>
 #include <zephyr/settings/settings.h>
 
+#include "ec_matrix_calibration_format.h"
 #include "ec_matrix_settings.h"
 #include "zmk_kscan_ec_matrix.h"
 #include <stdio.h>
@@ -12,107 +14,600 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(zmk_kscan_ec_matrix_settings);
 
-#define MAX_SETTING_LEN 32
+#define DT_DRV_COMPAT zmk_kscan_ec_matrix
+
+#define MAX_SETTING_LEN (SETTINGS_MAX_NAME_LEN + 1)
+
+#define ENTRIES(n) DT_INST_PROP_LEN(n, strobe_gpios) * DT_INST_PROP_LEN(n, input_gpios)
+
+// Settings layout below zmk/ec/calibration/<dev>:
+//   hdr  zmk_kscan_ec_matrix_calibration_header
+//   c<k> entries k * CHUNK_ENTRIES onwards, up to CHUNK_ENTRIES of them
+// Older firmware stored either all entries as one value at zmk/ec/calibration/<dev>, or each
+// entry under its index. Both are still loaded when no header exists, and deleted by the next
+// save.
+
+struct settings_instance {
+    const struct device *dev;
+    uint8_t strobes;
+    uint8_t inputs;
+    size_t len;
+    struct k_work save_work;
+    // Copy of the calibration taken when the save was requested, written out by save_work. Also
+    // stages loaded chunks until they are verified.
+    struct zmk_kscan_ec_matrix_calibration_entry *snapshot;
+    // Entries as last loaded from or saved to settings, so saves only rewrite the chunks that
+    // changed.
+    struct zmk_kscan_ec_matrix_calibration_entry *persisted;
+    bool persisted_valid;
+    bool legacy_blob;
+    bool legacy_discrete;
+    // Whether the snapshot holds staged legacy values, which may only cover some of the entries.
+    bool staged_legacy;
+    zmk_kscan_ec_matrix_settings_save_cb_t save_callback;
+    const void *save_user_data;
+    atomic_t save_busy;
+    int save_status;
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_ASYNC_LOAD)
+    struct k_work_delayable load_work;
+    // Attempts left to swap in the staged calibration, or 0 while none is staged.
+    uint8_t load_attempts_left;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_ASYNC_LOAD)
+};
+
+static void save_work_handler(struct k_work *work);
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_ASYNC_LOAD)
+static void load_work_handler(struct k_work *work);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_ASYNC_LOAD)
+
+#define SETTINGS_INSTANCE_ENTRIES(n)                                                               \
+    static struct zmk_kscan_ec_matrix_calibration_entry snapshot_entries_##n[ENTRIES(n)];         \
+    static struct zmk_kscan_ec_matrix_calibration_entry persisted_entries_##n[ENTRIES(n)];
+
+DT_INST_FOREACH_STATUS_OKAY(SETTINGS_INSTANCE_ENTRIES)
+
+#define SETTINGS_INSTANCE(n)                                                                       \
+    {                                                                                              \
+        .dev = DEVICE_DT_GET(DT_DRV_INST(n)),                                                      \
+        .strobes = DT_INST_PROP_LEN(n, strobe_gpios),                                              \
+        .inputs = DT_INST_PROP_LEN(n, input_gpios),                                                \
+        .len = ENTRIES(n),                                                                         \
+        .save_work = Z_WORK_INITIALIZER(save_work_handler),                                        \
+        .snapshot = snapshot_entries_##n,                                                          \
+        .persisted = persisted_entries_##n,                                                        \
+        IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_ASYNC_LOAD,                                 \
+                   (.load_work = Z_WORK_DELAYABLE_INITIALIZER(load_work_handler), ))               \
+    },
+
+static struct settings_instance settings_instances[] = {
+    DT_INST_FOREACH_STATUS_OKAY(SETTINGS_INSTANCE)};
+
+static struct settings_instance *settings_instance_for(const struct device *dev) {
+    for (size_t i = 0; i < ARRAY_SIZE(settings_instances); i++) {
+        if (settings_instances[i].dev == dev) {
+            return &settings_instances[i];
+        }
+    }
+
+    return NULL;
+}
+
+static inline size_t chunk_len(const struct settings_instance *inst, size_t chunk) {
+    return MIN(ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES,
+               inst->len - (chunk * ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES));
+}
 
 struct load_state {
-    char setting_name[MAX_SETTING_LEN];
+    struct settings_instance *inst;
     struct zmk_kscan_ec_matrix_calibration_entry *entries;
-    size_t len;
+    bool legacy;
+    bool header_found;
+    bool chunks_invalid;
+    size_t chunks_loaded;
+    struct zmk_kscan_ec_matrix_calibration_header header;
 };
 
-static int settings_load_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
-                            void *param) {
-    struct load_state *state = (struct load_state *)param;
+static int load_chunked(struct load_state *state, const char *key, size_t len,
+                        settings_read_cb read_cb, void *cb_arg) {
+    struct settings_instance *inst = state->inst;
 
-#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_DISCRETE)
+    if (!key) {
+        return 0;
+    }
 
-    if (len != sizeof(struct zmk_kscan_ec_matrix_calibration_entry)) {
-        LOG_WRN("Ignoring settings with incorrect size");
-        return -EINVAL;
+    if (strcmp(key, "hdr") == 0) {
+        if (len != sizeof(state->header)) {
+            LOG_WRN("Ignoring calibration header with incorrect size");
+            return 0;
+        }
+
+        ssize_t ret = read_cb(cb_arg, &state->header, len);
+        if (ret < 0) {
+            LOG_ERR("Failed to load the settings from flash");
+            return ret;
+        }
+
+        state->header_found = true;
+        return 0;
+    }
+
+    if (key[0] != 'c') {
+        return 0;
     }
 
     char *endptr;
-    size_t entry_id = strtoul(key, &endptr, 10);
-    if (endptr != key) {
-        if (entry_id >= state->len) {
-            LOG_WRN("Ignoring calibration for invalid index %d, skipping", entry_id);
+    size_t chunk = strtoul(key + 1, &endptr, 10);
+    if (endptr == key + 1 || *endptr != '\0') {
+        return 0;
+    }
+
+    if (chunk >= zmk_kscan_ec_matrix_calibration_chunks(inst->len) ||
+        len != chunk_len(inst, chunk) * sizeof(struct zmk_kscan_ec_matrix_calibration_entry)) {
+        LOG_WRN("Calibration chunk %zu does not fit this matrix", chunk);
+        state->chunks_invalid = true;
+        return 0;
+    }
+
+    ssize_t ret =
+        read_cb(cb_arg, &inst->snapshot[chunk * ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES], len);
+    if (ret < 0) {
+        LOG_ERR("Failed to load the settings from flash");
+        return ret;
+    }
+
+    state->chunks_loaded++;
+    return 0;
+}
+
+static int load_legacy(struct load_state *state, const char *key, size_t len,
+                       settings_read_cb read_cb, void *cb_arg) {
+    struct settings_instance *inst = state->inst;
+
+    if (!key) {
+        if (len != inst->len * sizeof(struct zmk_kscan_ec_matrix_calibration_entry) &&
+            len != inst->len * ZMK_KSCAN_EC_MATRIX_CALIBRATION_ENTRY_LEGACY_SIZE) {
+            LOG_WRN("Ignoring settings with incorrect size");
             return 0;
         }
-        ssize_t ret = read_cb(cb_arg, &state->entries[entry_id], len);
+
+        ssize_t ret = read_cb(cb_arg, state->entries, len);
         if (ret < 0) {
             LOG_ERR("Failed to load the settings from flash");
             return ret;
         }
+
+        if (len == inst->len * ZMK_KSCAN_EC_MATRIX_CALIBRATION_ENTRY_LEGACY_SIZE) {
+            // Spread the packed legacy entries out in place, last first since each one moves up.
+            const size_t legacy_size = ZMK_KSCAN_EC_MATRIX_CALIBRATION_ENTRY_LEGACY_SIZE;
+
+            for (size_t i = inst->len; i-- > 0;) {
+                struct zmk_kscan_ec_matrix_calibration_entry entry = {0};
+
+                memcpy(&entry, (uint8_t *)state->entries + (i * legacy_size), legacy_size);
+                state->entries[i] = entry;
+            }
+        }
+
+        inst->legacy_blob = true;
+        return 0;
     }
-#else
-    ssize_t ret = read_cb(cb_arg, state->entries,
-                          state->len * sizeof(struct zmk_kscan_ec_matrix_calibration_entry));
+
+    char *endptr;
+    size_t entry_id = strtoul(key, &endptr, 10);
+    if (endptr == key || *endptr != '\0') {
+        return 0;
+    }
+
+    if (len != sizeof(struct zmk_kscan_ec_matrix_calibration_entry) &&
+        len != ZMK_KSCAN_EC_MATRIX_CALIBRATION_ENTRY_LEGACY_SIZE) {
+        LOG_WRN("Ignoring settings with incorrect size");
+        return 0;
+    }
+
+    if (entry_id >= inst->len) {
+        LOG_WRN("Ignoring calibration for invalid index %d, skipping", entry_id);
+        return 0;
+    }
+
+    // Legacy entries leave noise_sigma at 0, falling back to the peak to peak noise.
+    memset(&state->entries[entry_id], 0, sizeof(struct zmk_kscan_ec_matrix_calibration_entry));
+    ssize_t ret = read_cb(cb_arg, &state->entries[entry_id], len);
     if (ret < 0) {
         LOG_ERR("Failed to load the settings from flash");
+        return ret;
     }
 
-    return ret;
-#endif
+    inst->legacy_discrete = true;
     return 0;
 }
 
-static void load_cb(const struct device *dev, struct zmk_kscan_ec_matrix_calibration_entry *entries,
-                    size_t len, const void *user_data) {
-    struct load_state state = (struct load_state){.entries = entries, .len = len};
-    snprintf(state.setting_name, MAX_SETTING_LEN, "zmk/ec/calibration/%s", dev->name);
-    LOG_DBG("Loading the subtree directly for %s", state.setting_name);
-    settings_load_subtree_direct(state.setting_name, settings_load_cb, &state);
+static int settings_load_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
+                            void *param) {
+    struct load_state *state = (struct load_state *)param;
+
+    if (state->legacy) {
+        return load_legacy(state, key, len, read_cb, cb_arg);
+    }
+
+    return load_chunked(state, key, len, read_cb, cb_arg);
 }
 
-static void save_cb(const struct device *dev, struct zmk_kscan_ec_matrix_calibration_entry *entries,
-                    size_t len, const void *user_data) {
-    char setting_name[MAX_SETTING_LEN];
+static bool header_valid(const struct load_state *state) {
+    const struct settings_instance *inst = state->inst;
+    const struct zmk_kscan_ec_matrix_calibration_header *header = &state->header;
+
+    if (header->version != ZMK_KSCAN_EC_MATRIX_CALIBRATION_FORMAT_VERSION) {
+        LOG_ERR("Stored calibration has unknown version %d", header->version);
+        return false;
+    }
+
+    if (header->strobes != inst->strobes || header->inputs != inst->inputs ||
+        header->chunk_entries != ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES) {
+        LOG_ERR("Stored calibration is for a %dx%d matrix, not %dx%d", header->strobes,
+                header->inputs, inst->strobes, inst->inputs);
+        return false;
+    }
+
+    if (state->chunks_invalid ||
+        state->chunks_loaded != zmk_kscan_ec_matrix_calibration_chunks(inst->len)) {
+        LOG_ERR("Stored calibration is incomplete");
+        return false;
+    }
+
+    if (header->crc != zmk_kscan_ec_matrix_calibration_crc(inst->snapshot, inst->len)) {
+        LOG_ERR("Stored calibration fails its CRC check");
+        return false;
+    }
+
+    return true;
+}
+
+static bool apply_cb(const struct device *dev,
+                     struct zmk_kscan_ec_matrix_calibration_entry *entries, size_t len,
+                     const void *user_data) {
+    const struct settings_instance *inst = (const struct settings_instance *)user_data;
+
+    memcpy(entries, inst->snapshot, len * sizeof(struct zmk_kscan_ec_matrix_calibration_entry));
+
+    return true;
+}
+
+// Staged legacy entries start out filled with this byte, which no real calibration is made of, to
+// tell apart the entries the legacy values did not cover.
+#define UNLOADED_ENTRY_BYTE 0xFF
+
+static inline bool entry_loaded(const struct zmk_kscan_ec_matrix_calibration_entry *entry) {
+    return entry->avg_low != UINT16_MAX || entry->avg_high != UINT16_MAX ||
+           entry->noise != UINT16_MAX || entry->noise_sigma != UINT16_MAX;
+}
+
+static bool apply_legacy_cb(const struct device *dev,
+                            struct zmk_kscan_ec_matrix_calibration_entry *entries, size_t len,
+                            const void *user_data) {
+    const struct settings_instance *inst = (const struct settings_instance *)user_data;
 
-#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_DISCRETE)
     for (size_t i = 0; i < len; i++) {
-        snprintf(setting_name, MAX_SETTING_LEN, "zmk/ec/calibration/%s/%d", dev->name, i);
-        int ret = settings_save_one(setting_name, &entries[i],
-                                    sizeof(struct zmk_kscan_ec_matrix_calibration_entry));
+        if (entry_loaded(&inst->snapshot[i])) {
+            entries[i] = inst->snapshot[i];
+        }
+    }
+
+    return true;
+}
+
+// Reads the stored calibration into the snapshot without holding the scan lock, so scanning
+// carries on with the current calibration until apply_staged_calibration() swaps the verified
+// one in. Returns -ENOENT if no calibration is stored.
+static int stage_calibration(struct settings_instance *inst) {
+    struct load_state state = (struct load_state){.inst = inst, .entries = inst->snapshot};
+    char setting_name[MAX_SETTING_LEN];
+
+    snprintf(setting_name, MAX_SETTING_LEN, "zmk/ec/calibration/%s", inst->dev->name);
+    LOG_DBG("Loading the subtree directly for %s", setting_name);
+    int ret = settings_load_subtree_direct(setting_name, settings_load_cb, &state);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (!state.header_found) {
+        // Rewritten in the current layout by the next save.
+        inst->persisted_valid = false;
+        inst->legacy_blob = false;
+        inst->legacy_discrete = false;
+
+        memset(inst->snapshot, UNLOADED_ENTRY_BYTE,
+               inst->len * sizeof(struct zmk_kscan_ec_matrix_calibration_entry));
+        state = (struct load_state){.inst = inst, .entries = inst->snapshot, .legacy = true};
+        ret = settings_load_subtree_direct(setting_name, settings_load_cb, &state);
+        if (ret < 0) {
+            return ret;
+        }
+
+        if (!inst->legacy_blob && !inst->legacy_discrete) {
+            return -ENOENT;
+        }
+
+        inst->staged_legacy = true;
+        return 0;
+    }
+
+    // A rejected calibration leaves the current one, e.g. the devicetree seed, in place.
+    if (!header_valid(&state)) {
+        inst->persisted_valid = false;
+        return -EINVAL;
+    }
+
+    inst->staged_legacy = false;
+    return 0;
+}
+
+// Swaps the calibration staged by stage_calibration() in, waiting at most timeout for the scan
+// lock.
+static int apply_staged_calibration(struct settings_instance *inst, k_timeout_t timeout) {
+    int ret = zmk_kscan_ec_matrix_try_access_calibration(
+        inst->dev, inst->staged_legacy ? &apply_legacy_cb : &apply_cb, inst, timeout);
+    if (ret < 0 || inst->staged_legacy) {
+        return ret;
+    }
+
+    memcpy(inst->persisted, inst->snapshot,
+           inst->len * sizeof(struct zmk_kscan_ec_matrix_calibration_entry));
+    inst->persisted_valid = true;
+
+    return 0;
+}
+
+static void delete_legacy(struct settings_instance *inst) {
+    char setting_name[MAX_SETTING_LEN];
+
+    if (inst->legacy_blob) {
+        snprintf(setting_name, MAX_SETTING_LEN, "zmk/ec/calibration/%s", inst->dev->name);
+        settings_delete(setting_name);
+        inst->legacy_blob = false;
+    }
+
+    if (inst->legacy_discrete) {
+        for (size_t i = 0; i < inst->len; i++) {
+            snprintf(setting_name, MAX_SETTING_LEN, "zmk/ec/calibration/%s/%zu", inst->dev->name,
+                     i);
+            settings_delete(setting_name);
+        }
+        inst->legacy_discrete = false;
+    }
+}
+
+static int save_entries(struct settings_instance *inst) {
+    const struct zmk_kscan_ec_matrix_calibration_entry *entries = inst->snapshot;
+    char setting_name[MAX_SETTING_LEN];
+    bool changed = !inst->persisted_valid;
+    int ret;
+
+    for (size_t chunk = 0; chunk < zmk_kscan_ec_matrix_calibration_chunks(inst->len); chunk++) {
+        size_t offset = chunk * ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES;
+        size_t size = chunk_len(inst, chunk) * sizeof(struct zmk_kscan_ec_matrix_calibration_entry);
+
+        if (inst->persisted_valid &&
+            memcmp(&inst->persisted[offset], &entries[offset], size) == 0) {
+            continue;
+        }
+
+        // A truncated name could collide with the header or another chunk.
+        if (snprintf(setting_name, MAX_SETTING_LEN, "zmk/ec/calibration/%s/c%zu",
+                     inst->dev->name, chunk) >= MAX_SETTING_LEN) {
+            inst->persisted_valid = false;
+            return -ENAMETOOLONG;
+        }
+
+        ret = settings_save_one(setting_name, &entries[offset], size);
         if (ret != 0) {
             LOG_WRN("Failed to save the settings for %s: %d", setting_name, ret);
-            break;
+            // The stored header no longer matches, so the next save rewrites everything.
+            inst->persisted_valid = false;
+            return ret;
         }
+
+        memcpy(&inst->persisted[offset], &entries[offset], size);
+        changed = true;
+    }
+
+    if (!changed) {
+        return 0;
     }
-#else
-    snprintf(setting_name, MAX_SETTING_LEN, "zmk/ec/calibration/%s", dev->name);
 
-    int ret = settings_save_one(setting_name, entries,
-                                len * sizeof(struct zmk_kscan_ec_matrix_calibration_entry));
+    // Written last, so a save cut short leaves a CRC mismatch rather than a mixed calibration.
+    struct zmk_kscan_ec_matrix_calibration_header header = {
+        .version = ZMK_KSCAN_EC_MATRIX_CALIBRATION_FORMAT_VERSION,
+        .strobes = inst->strobes,
+        .inputs = inst->inputs,
+        .chunk_entries = ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES,
+        .crc = zmk_kscan_ec_matrix_calibration_crc(entries, inst->len),
+    };
 
+    if (snprintf(setting_name, MAX_SETTING_LEN, "zmk/ec/calibration/%s/hdr", inst->dev->name) >=
+        MAX_SETTING_LEN) {
+        inst->persisted_valid = false;
+        return -ENAMETOOLONG;
+    }
+
+    ret = settings_save_one(setting_name, &header, sizeof(header));
     if (ret != 0) {
         LOG_WRN("Failed to save the settings for %s: %d", setting_name, ret);
+        inst->persisted_valid = false;
+        return ret;
+    }
+
+    inst->persisted_valid = true;
+    delete_legacy(inst);
+
+    return 0;
+}
+
+// Does the flash I/O of a save away from the scan thread, which only waited for the snapshot.
+static void save_work_handler(struct k_work *work) {
+    struct settings_instance *inst = CONTAINER_OF(work, struct settings_instance, save_work);
+    zmk_kscan_ec_matrix_settings_save_cb_t callback = inst->save_callback;
+    const void *user_data = inst->save_user_data;
+
+    inst->save_status = save_entries(inst);
+
+    // Cleared first so the callback can request the next save.
+    atomic_clear(&inst->save_busy);
+
+    if (callback) {
+        callback(inst->dev, inst->save_status, user_data);
     }
-#endif
 }
 
 int zmk_kscan_ec_matrix_settings_load_calibration(const struct device *dev) {
-    int ret = zmk_kscan_ec_matrix_access_calibration(dev, &load_cb, NULL);
+    struct settings_instance *inst = settings_instance_for(dev);
+
+    if (!inst) {
+        return -ENODEV;
+    }
+
+    // The snapshot and persisted image belong to the save in flight.
+    if (!atomic_cas(&inst->save_busy, 0, 1)) {
+        return -EBUSY;
+    }
+
+    int ret = stage_calibration(inst);
+    if (ret == 0) {
+        ret = apply_staged_calibration(inst, K_SECONDS(1));
+    }
+
+    atomic_clear(&inst->save_busy);
+
     return ret;
 }
 
-int zmk_kscan_ec_matrix_settings_save_calibration(const struct device *dev) {
-    int ret = zmk_kscan_ec_matrix_access_calibration(dev, &save_cb, NULL);
-    return ret;
+int zmk_kscan_ec_matrix_settings_save_calibration(const struct device *dev,
+                                                  zmk_kscan_ec_matrix_settings_save_cb_t cb,
+                                                  const void *user_data) {
+    struct settings_instance *inst = settings_instance_for(dev);
+
+    if (!inst) {
+        return -ENODEV;
+    }
+
+    if (!atomic_cas(&inst->save_busy, 0, 1)) {
+        return -EBUSY;
+    }
+
+    int ret = zmk_kscan_ec_matrix_copy_calibration(dev, inst->snapshot, inst->len);
+    if (ret < 0) {
+        atomic_clear(&inst->save_busy);
+        return ret;
+    }
+
+    inst->save_callback = cb;
+    inst->save_user_data = user_data;
+    inst->save_status = -EINPROGRESS;
+    k_work_submit(&inst->save_work);
+
+    return 0;
+}
+
+int zmk_kscan_ec_matrix_settings_save_status(const struct device *dev) {
+    struct settings_instance *inst = settings_instance_for(dev);
+
+    if (!inst) {
+        return -ENODEV;
+    }
+
+    return inst->save_status;
 }
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_INIT_LOAD)
-#define DT_DRV_COMPAT zmk_kscan_ec_matrix
 
-#define LOAD_CALL(n) zmk_kscan_ec_matrix_settings_load_calibration(DEVICE_DT_GET(DT_DRV_INST(n)));
+static void init_load_done(const struct device *dev, int ret) {
+    if (ret == -ENOENT) {
+        LOG_INF("No stored calibration for %s", dev->name);
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+        zmk_kscan_ec_matrix_boot_timing_calibration_absent(dev);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+        return;
+    }
+
+    if (ret < 0) {
+        LOG_WRN("Failed to load the stored calibration of %s (%d)", dev->name, ret);
+        return;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+    zmk_kscan_ec_matrix_boot_timing_calibration_loaded(dev);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_ASYNC_LOAD)
+
+#define LOAD_RETRY_MS 100
+// Gives up on swapping in the stored calibration after about 10s, e.g. when the matrix is never
+// enabled.
+#define LOAD_ATTEMPTS 100
+
+static void load_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct settings_instance *inst = CONTAINER_OF(dwork, struct settings_instance, load_work);
+    int ret;
+
+    if (inst->load_attempts_left == 0) {
+        settings_subsys_init();
+
+        // The snapshot stays claimed until the staged calibration is swapped in.
+        if (!atomic_cas(&inst->save_busy, 0, 1)) {
+            k_work_reschedule(dwork, K_MSEC(LOAD_RETRY_MS));
+            return;
+        }
+
+        ret = stage_calibration(inst);
+        if (ret < 0) {
+            atomic_clear(&inst->save_busy);
+            init_load_done(inst->dev, ret);
+            return;
+        }
+
+        inst->load_attempts_left = LOAD_ATTEMPTS;
+    }
+
+    // The scan lock is held until the matrix is first enabled, and by every scan in progress.
+    // Scanning already runs on the devicetree seed meanwhile, so rather than blocking the shared
+    // work queue on the lock, just try again later. Flash is not read again.
+    ret = apply_staged_calibration(inst, K_NO_WAIT);
+    if (ret == -EAGAIN && --inst->load_attempts_left > 0) {
+        k_work_reschedule(dwork, K_MSEC(LOAD_RETRY_MS));
+        return;
+    }
+
+    inst->load_attempts_left = 0;
+    atomic_clear(&inst->save_busy);
+    init_load_done(inst->dev, ret);
+}
+
+static int zmk_kscan_ec_matrix_settings_init(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(settings_instances); i++) {
+        k_work_schedule(&settings_instances[i].load_work, K_NO_WAIT);
+    }
+
+    return 0;
+}
+
+#else
 
 static int zmk_kscan_ec_matrix_settings_init(void) {
     // TODO: Avoid duplicating this from the ZMK call to init?
     settings_subsys_init();
-    DT_INST_FOREACH_STATUS_OKAY(LOAD_CALL)
+
+    for (size_t i = 0; i < ARRAY_SIZE(settings_instances); i++) {
+        const struct device *dev = settings_instances[i].dev;
+
+        init_load_done(dev, zmk_kscan_ec_matrix_settings_load_calibration(dev));
+    }
 
     return 0;
 }
 
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_ASYNC_LOAD)
+
 SYS_INIT(zmk_kscan_ec_matrix_settings_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
 
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS_INIT_LOAD)
@@ -3,5 +3,16 @@
 
 #include "zmk_kscan_ec_matrix.h"
 
+typedef void (*zmk_kscan_ec_matrix_settings_save_cb_t)(const struct device *dev, int status,
+                                                       const void *user_data);
+
 int zmk_kscan_ec_matrix_settings_load_calibration(const struct device *dev);
-int zmk_kscan_ec_matrix_settings_save_calibration(const struct device *dev);
\ No newline at end of file
+
+// Snapshots the calibration and saves it from the system work queue, so scanning never waits on
+// flash. cb, if any, is called from the work queue with the result once the save is done.
+int zmk_kscan_ec_matrix_settings_save_calibration(const struct device *dev,
+                                                  zmk_kscan_ec_matrix_settings_save_cb_t cb,
+                                                  const void *user_data);
+
+// Returns the result of the last save, -EINPROGRESS while it is in flight.
+int zmk_kscan_ec_matrix_settings_save_status(const struct device *dev);
\ No newline at end of file
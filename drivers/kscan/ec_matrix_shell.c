@@ -6,11 +6,14 @@
 
 #include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/shell/shell.h>
+#include <zephyr/sys/base64.h>
 #include <zephyr/sys/util.h>
 
+#include "ec_matrix_calibration_format.h"
 #include "ec_matrix_settings.h"
 #include "zmk_kscan_ec_matrix.h"
 
@@ -22,24 +25,44 @@ LOG_MODULE_REGISTER(ec_matrix_shell);
 
 #define CMD_HELP_SCAN_RATE "Print EC Scan Rate.\n"
 #define CMD_HELP_READ_TIMING "Print EC Read Timing.\n"
+#define CMD_HELP_BOOT_TIMING "Print when the EC Matrix became usable after boot.\n"
+#define CMD_HELP_TRACE "Drain and print the EC raw sample trace.\n"
+#define CMD_HELP_ANALOG "Print the latest EC analog travel frame in percent.\n"
 #define CMD_HELP_CALIBRATE "EC Calibration Utilities.\n"
-#define CMD_HELP_CALIBRATION_START "Calibrate the EC Martix.\n"
-#define CMD_HELP_CALIBRATION_EXPORT "Export calibration data as DTS props.\n"
+#define CMD_HELP_CALIBRATION_START                                                                 \
+    "Calibrate the EC Martix.\n"                                                                   \
+    "Usage: start [<strobe>,<input>...]\n"                                                         \
+    "With positions, only recalibrates those keys.\n"
+#define CMD_HELP_CALIBRATION_EXPORT                                                                \
+    "Export calibration data as DTS props.\n"                                                      \
+    "Usage: export [--blob]\n"                                                                     \
+    "With --blob, prints the whole calibration as one checksummed base64 line for import.\n"
+#define CMD_HELP_CALIBRATION_IMPORT                                                                \
+    "Import calibration data exported with export --blob.\n"                                      \
+    "Usage: import <base64>\n"                                                                     \
+    "CONFIG_SHELL_CMD_BUFF_SIZE must fit the whole line.\n"
+#define CMD_HELP_CALIBRATION_SKIP                                                                  \
+    "Skip keys of the calibration in progress, keeping their previous calibration.\n"             \
+    "Usage: skip [<strobe>,<input>...]\n"                                                          \
+    "Without positions, skips all keys left.\n"
 
 #define CMD_HELP_CALIBRATION_SAVE "Save the EC Martix Calibration To Flash.\n"
 
 #define CMD_HELP_CALIBRATION_LOAD "Load the EC Martix Calibration From Flash.\n"
 
-#define DEVICES(n) DEVICE_DT_INST_GET(n),
-
-#define INIT_MACRO() DT_INST_FOREACH_STATUS_OKAY(DEVICES) NULL
-
-#define EC_MATRIX_ENTRY(dev_) {.dev = dev_}
+#define EC_MATRIX_ENTRY(n)                                                                         \
+    {                                                                                              \
+        .dev = DEVICE_DT_INST_GET(n),                                                              \
+        .strobes = DT_INST_PROP_LEN(n, strobe_gpios),                                              \
+        .inputs = DT_INST_PROP_LEN(n, input_gpios),                                                \
+    },
 
 /* This table size is = ADC devices count + 1 (NA). */
 static struct matrix_hdl {
     const struct device *dev;
-} matrix_hdl_list[] = {FOR_EACH(EC_MATRIX_ENTRY, (, ), INIT_MACRO())};
+    uint8_t strobes;
+    uint8_t inputs;
+} matrix_hdl_list[] = {DT_INST_FOREACH_STATUS_OKAY(EC_MATRIX_ENTRY){.dev = NULL}};
 
 static struct matrix_hdl *get_matrix(const char *device_label) {
     for (int i = 0; i < ARRAY_SIZE(matrix_hdl_list); i++) {
@@ -61,7 +84,6 @@ static void calibrate_cb(const struct zmk_kscan_ec_matrix_calibration_event *ev,
     case CALIBRATION_EV_LOW_SAMPLING_START:
         shell_prompt_change(sh, "-");
         shell_print(sh, "Low value sampling begins. Please do not press any keys");
-        k_sleep(K_SECONDS(1));
         break;
     case CALIBRATION_EV_HIGH_SAMPLING_START:
         shell_prompt_change(sh, "-");
@@ -93,15 +115,73 @@ static void calibrate_cb(const struct zmk_kscan_ec_matrix_calibration_event *ev,
         shell_prompt_change(sh, CONFIG_SHELL_PROMPT_UART);
         shell_print(sh, "\nCalibration complete!");
         break;
+    case CALIBRATION_EV_POSITION_TIMEOUT:
+        shell_print(sh, "\nKey at (%d,%d) timed out and keeps its previous calibration",
+                    ev->data.position_skipped.strobe, ev->data.position_skipped.input);
+        break;
+    case CALIBRATION_EV_POSITION_SKIPPED:
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_VERBOSE_CALIBRATOR)
+        shell_print(sh, "Key at (%d,%d) is skipped", ev->data.position_skipped.strobe,
+                    ev->data.position_skipped.input);
+#else
+        shell_fprintf(sh, SHELL_NORMAL, "-");
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_VERBOSE_CALIBRATOR)
+        break;
+    case CALIBRATION_EV_PROGRESS:
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_VERBOSE_CALIBRATOR)
+        shell_print(sh, "%d/%d keys done", ev->data.progress.completed, ev->data.progress.total);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_VERBOSE_CALIBRATOR)
+        break;
+    }
+}
+
+// Parses a "<strobe>,<input>" key position.
+static int parse_position(const char *arg, uint8_t *strobe, uint8_t *input) {
+    char *end;
+    unsigned long s = strtoul(arg, &end, 10);
+
+    if (end == arg || *end != ',') {
+        return -EINVAL;
     }
+
+    const char *input_arg = end + 1;
+    unsigned long i = strtoul(input_arg, &end, 10);
+
+    if (end == input_arg || *end != '\0' || s > UINT8_MAX || i > UINT8_MAX) {
+        return -EINVAL;
+    }
+
+    *strobe = s;
+    *input = i;
+
+    return 0;
 }
 
 static int cmd_matrix_calibration_start(const struct shell *shell, size_t argc, char **argv,
                                         void *data) {
     /* -2: index of ADC label name */
     struct matrix_hdl *matrix = get_matrix(argv[-2]);
+    struct zmk_kscan_ec_matrix_position positions[CONFIG_SHELL_ARGC_MAX];
+    size_t len = 0;
+    int ret;
+
+    for (size_t a = 1; a < argc && len < ARRAY_SIZE(positions); a++) {
+        ret = parse_position(argv[a], &positions[len].strobe, &positions[len].input);
+        if (ret < 0) {
+            shell_error(shell, "Invalid key position %s, expected <strobe>,<input>", argv[a]);
+            return ret;
+        }
+
+        len++;
+    }
+
+    if (len > 0) {
+        ret = zmk_kscan_ec_matrix_calibrate_positions(matrix->dev, positions, len, &calibrate_cb,
+                                                      shell);
+    } else {
+        ret = zmk_kscan_ec_matrix_calibrate(matrix->dev, &calibrate_cb, shell);
+    }
 
-    int ret = zmk_kscan_ec_matrix_calibrate(matrix->dev, &calibrate_cb, shell);
     if (ret < 0) {
         shell_print(shell, "Failed to start calibration (%d)", ret);
     }
@@ -109,7 +189,41 @@ static int cmd_matrix_calibration_start(const struct shell *shell, size_t argc,
     return ret;
 }
 
-static void export_cb(const struct device *dev,
+static int cmd_matrix_calibration_skip(const struct shell *shell, size_t argc, char **argv,
+                                       void *data) {
+    /* -2: index of ADC label name */
+    struct matrix_hdl *matrix = get_matrix(argv[-2]);
+    int ret;
+
+    if (argc < 2) {
+        ret = zmk_kscan_ec_matrix_calibration_skip_remaining(matrix->dev);
+        if (ret < 0) {
+            shell_print(shell, "Failed to skip the keys left (%d)", ret);
+        }
+
+        return ret;
+    }
+
+    for (size_t a = 1; a < argc; a++) {
+        uint8_t strobe, input;
+
+        ret = parse_position(argv[a], &strobe, &input);
+        if (ret < 0) {
+            shell_error(shell, "Invalid key position %s, expected <strobe>,<input>", argv[a]);
+            return ret;
+        }
+
+        ret = zmk_kscan_ec_matrix_calibration_skip(matrix->dev, strobe, input);
+        if (ret < 0) {
+            shell_print(shell, "Failed to skip key (%d,%d) (%d)", strobe, input, ret);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+static bool export_cb(const struct device *dev,
                       struct zmk_kscan_ec_matrix_calibration_entry *entries, size_t len,
                       const void *user_data) {
     const struct shell *shell = (const struct shell *)user_data;
@@ -124,6 +238,58 @@ static void export_cb(const struct device *dev,
         shell_print(shell, "\t\t%d", entries[i].avg_low);
     }
     shell_print(shell, "\t>;");
+
+    return false;
+}
+
+#define BLOB_ENTRIES(n) +(DT_INST_PROP_LEN(n, strobe_gpios) * DT_INST_PROP_LEN(n, input_gpios))
+#define BLOB_MAX_ENTRIES (0 DT_INST_FOREACH_STATUS_OKAY(BLOB_ENTRIES))
+
+// Bytes encoded per shell_fprintf() call, a multiple of 3 so the pieces join into one base64 line.
+#define BLOB_PIECE_BYTES 48
+
+// Calibration blob moved by export --blob and import, the same header and entries as stored in
+// settings. Sized for the calibration of any of the matrices.
+static struct {
+    struct zmk_kscan_ec_matrix_calibration_header header;
+    struct zmk_kscan_ec_matrix_calibration_entry entries[BLOB_MAX_ENTRIES];
+} blob;
+
+static inline size_t blob_size(const struct matrix_hdl *matrix) {
+    return sizeof(blob.header) + (matrix->strobes * matrix->inputs * sizeof(blob.entries[0]));
+}
+
+static int export_blob(const struct shell *shell, const struct matrix_hdl *matrix) {
+    size_t len = matrix->strobes * matrix->inputs;
+
+    int ret = zmk_kscan_ec_matrix_copy_calibration(matrix->dev, blob.entries, len);
+    if (ret < 0) {
+        shell_print(shell, "Failed to access calibration data to export (%d)", ret);
+        return ret;
+    }
+
+    blob.header = (struct zmk_kscan_ec_matrix_calibration_header){
+        .version = ZMK_KSCAN_EC_MATRIX_CALIBRATION_FORMAT_VERSION,
+        .strobes = matrix->strobes,
+        .inputs = matrix->inputs,
+        .chunk_entries = ZMK_KSCAN_EC_MATRIX_CALIBRATION_CHUNK_ENTRIES,
+        .crc = zmk_kscan_ec_matrix_calibration_crc(blob.entries, len),
+    };
+
+    const uint8_t *bytes = (const uint8_t *)&blob;
+    size_t size = blob_size(matrix);
+
+    for (size_t offset = 0; offset < size; offset += BLOB_PIECE_BYTES) {
+        uint8_t text[(BLOB_PIECE_BYTES / 3 * 4) + 1];
+        size_t text_len;
+
+        base64_encode(text, sizeof(text), &text_len, bytes + offset,
+                      MIN(BLOB_PIECE_BYTES, size - offset));
+        shell_fprintf(shell, SHELL_NORMAL, "%s", (const char *)text);
+    }
+    shell_fprintf(shell, SHELL_NORMAL, "\n");
+
+    return 0;
 }
 
 static int cmd_matrix_calibration_export(const struct shell *shell, size_t argc, char **argv,
@@ -131,6 +297,15 @@ static int cmd_matrix_calibration_export(const struct shell *shell, size_t argc,
     /* -2: index of ADC label name */
     struct matrix_hdl *matrix = get_matrix(argv[-2]);
 
+    if (argc > 1) {
+        if (strcmp(argv[1], "--blob") != 0) {
+            shell_error(shell, "Unknown option %s", argv[1]);
+            return -EINVAL;
+        }
+
+        return export_blob(shell, matrix);
+    }
+
     int ret = zmk_kscan_ec_matrix_access_calibration(matrix->dev, &export_cb, shell);
     if (ret < 0) {
         shell_print(shell, "Failed to access calibration data to export (%d)", ret);
@@ -139,6 +314,63 @@ static int cmd_matrix_calibration_export(const struct shell *shell, size_t argc,
     return ret;
 }
 
+static bool import_cb(const struct device *dev,
+                      struct zmk_kscan_ec_matrix_calibration_entry *entries, size_t len,
+                      const void *user_data) {
+    memcpy(entries, blob.entries, len * sizeof(entries[0]));
+
+    return true;
+}
+
+static int cmd_matrix_calibration_import(const struct shell *shell, size_t argc, char **argv,
+                                         void *data) {
+    /* -2: index of ADC label name */
+    struct matrix_hdl *matrix = get_matrix(argv[-2]);
+    size_t len = matrix->strobes * matrix->inputs;
+    size_t size = blob_size(matrix);
+    size_t decoded;
+
+    if (argc != 2) {
+        shell_error(shell, "Usage: import <base64>");
+        return -EINVAL;
+    }
+
+    // Also fails when the blob is larger than this matrix's calibration.
+    int ret = base64_decode((uint8_t *)&blob, size, &decoded, (const uint8_t *)argv[1],
+                            strlen(argv[1]));
+    if (ret < 0 || decoded != size) {
+        shell_error(shell, "Calibration blob is malformed or not for a %dx%d matrix",
+                    matrix->strobes, matrix->inputs);
+        return -EINVAL;
+    }
+
+    if (blob.header.version != ZMK_KSCAN_EC_MATRIX_CALIBRATION_FORMAT_VERSION) {
+        shell_error(shell, "Calibration blob has unknown version %d", blob.header.version);
+        return -EINVAL;
+    }
+
+    if (blob.header.strobes != matrix->strobes || blob.header.inputs != matrix->inputs) {
+        shell_error(shell, "Calibration blob is for a %dx%d matrix, not %dx%d",
+                    blob.header.strobes, blob.header.inputs, matrix->strobes, matrix->inputs);
+        return -EINVAL;
+    }
+
+    if (blob.header.crc != zmk_kscan_ec_matrix_calibration_crc(blob.entries, len)) {
+        shell_error(shell, "Calibration blob fails its CRC check");
+        return -EINVAL;
+    }
+
+    ret = zmk_kscan_ec_matrix_access_calibration(matrix->dev, &import_cb, NULL);
+    if (ret < 0) {
+        shell_print(shell, "Failed to access calibration data to import (%d)", ret);
+        return ret;
+    }
+
+    shell_print(shell, "Imported the calibration of %zu keys", len);
+
+    return 0;
+}
+
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
 
 static int cmd_matrix_scan_rate(const struct shell *shell, size_t argc, char **argv, void *data) {
@@ -150,6 +382,8 @@ static int cmd_matrix_scan_rate(const struct shell *shell, size_t argc, char **a
         shell_info(shell, "Matrix scan rate: %lluHz", scan_rate);
     }
 
+    shell_info(shell, "Scan overruns: %u", zmk_kscan_ec_matrix_scan_overruns(matrix->dev));
+
     return 0;
 }
 
@@ -169,6 +403,8 @@ static int cmd_matrix_read_timing(const struct shell *shell, size_t argc, char *
     struct zmk_kscan_ec_matrix_read_timing timing = zmk_kscan_ec_matrix_read_timing(matrix->dev);
 
     shell_print(shell, "Total time for a read: %lluns", timing.total_ns);
+    shell_print(shell, "Longest IRQ-locked window per scan: %lluns", timing.irq_locked_max_ns);
+    shell_print(shell, "Relax time saved per scan: %lluns", timing.relax_saved_ns);
     print_pct(shell, timing.total_ns, timing.adc_sequence_init_ns, "Sequence Init");
     print_pct(shell, timing.total_ns, timing.gpio_input_ns, "GPIO Input");
     print_pct(shell, timing.total_ns, timing.relax_ns, "Relax");
@@ -185,12 +421,113 @@ static int cmd_matrix_read_timing(const struct shell *shell, size_t argc, char *
 
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+
+static void print_boot_step(const struct shell *shell, uint32_t at_us, const char *label) {
+    if (at_us == 0) {
+        shell_print(shell, "%s: pending", label);
+    } else {
+        shell_print(shell, "%s: %uus", label, at_us);
+    }
+}
+
+static int cmd_matrix_boot_timing(const struct shell *shell, size_t argc, char **argv, void *data) {
+    struct matrix_hdl *matrix = get_matrix(argv[-1]);
+    struct zmk_kscan_ec_matrix_boot_timing timing = zmk_kscan_ec_matrix_boot_timing(matrix->dev);
+
+    print_boot_step(shell, timing.adc_calibrated_us, "ADC Calibrated");
+    print_boot_step(shell, timing.first_scan_us, "First Scan");
+    if (timing.calibration_absent_us != 0) {
+        print_boot_step(shell, timing.calibration_absent_us, "No Stored Calibration");
+    } else {
+        print_boot_step(shell, timing.calibration_loaded_us, "Calibration Loaded");
+    }
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+
+#define TRACE_DRAIN_BATCH 16
+
+static int cmd_matrix_trace(const struct shell *shell, size_t argc, char **argv, void *data) {
+    struct matrix_hdl *matrix = get_matrix(argv[-1]);
+    struct zmk_kscan_ec_matrix_trace_record records[TRACE_DRAIN_BATCH];
+    size_t count;
+
+    while ((count = zmk_kscan_ec_matrix_trace_drain(matrix->dev, records, TRACE_DRAIN_BATCH)) >
+           0) {
+        for (size_t i = 0; i < count; i++) {
+            shell_print(shell, "%u,%d,%d,%d,%d,%d", records[i].timestamp, records[i].strobe,
+                        records[i].input, records[i].raw, records[i].normalized,
+                        records[i].decision);
+        }
+    }
+
+    uint32_t dropped = zmk_kscan_ec_matrix_trace_dropped(matrix->dev);
+    if (dropped > 0) {
+        shell_warn(shell, "Dropped %u trace records", dropped);
+    }
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+
+static int cmd_matrix_analog(const struct shell *shell, size_t argc, char **argv, void *data) {
+    struct matrix_hdl *matrix = get_matrix(argv[-1]);
+    struct zmk_kscan_ec_matrix_analog_frame frame;
+
+    int ret = zmk_kscan_ec_matrix_analog_frame_get(matrix->dev, &frame);
+    if (ret < 0) {
+        shell_print(shell, "No analog frame available (%d)", ret);
+        return ret;
+    }
+
+    uint8_t pcts[frame.strobes_len * frame.inputs_len];
+    for (int i = 0; i < frame.strobes_len * frame.inputs_len; i++) {
+        pcts[i] = (frame.travel[i] * 100) / UINT16_MAX;
+    }
+
+    if (!zmk_kscan_ec_matrix_analog_frame_valid(matrix->dev, &frame)) {
+        shell_print(shell, "Analog frame was overwritten while reading, try again");
+        return -EAGAIN;
+    }
+
+    shell_print(shell, "Frame %u", frame.sequence);
+    for (int s = 0; s < frame.strobes_len; s++) {
+        shell_fprintf(shell, SHELL_NORMAL, "%2d:", s);
+        for (int i = 0; i < frame.inputs_len; i++) {
+            shell_fprintf(shell, SHELL_NORMAL, " %3d", pcts[(s * frame.inputs_len) + i]);
+        }
+        shell_fprintf(shell, SHELL_NORMAL, "\n");
+    }
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SETTINGS)
 
+static void save_done_cb(const struct device *dev, int status, const void *user_data) {
+    const struct shell *shell = (const struct shell *)user_data;
+
+    if (status < 0) {
+        shell_print(shell, "Failed to save calibration (%d)", status);
+    } else {
+        shell_print(shell, "Calibration saved");
+    }
+}
+
 static int cmd_matrix_calibration_save(const struct shell *shell, size_t argc, char **argv,
                                        void *data) {
     struct matrix_hdl *matrix = get_matrix(argv[-2]);
-    int ret = zmk_kscan_ec_matrix_settings_save_calibration(matrix->dev);
+    int ret = zmk_kscan_ec_matrix_settings_save_calibration(matrix->dev, &save_done_cb, shell);
     if (ret < 0) {
         shell_print(shell, "Failed to initiate save calibration (%d)", ret);
     }
@@ -202,7 +539,9 @@ static int cmd_matrix_calibration_load(const struct shell *shell, size_t argc, c
                                        void *data) {
     struct matrix_hdl *matrix = get_matrix(argv[-2]);
     int ret = zmk_kscan_ec_matrix_settings_load_calibration(matrix->dev);
-    if (ret < 0) {
+    if (ret == -ENOENT) {
+        shell_print(shell, "No stored calibration to load");
+    } else if (ret < 0) {
         shell_print(shell, "Failed to initiate load calibration (%d)", ret);
     }
 
@@ -216,6 +555,8 @@ SHELL_STATIC_SUBCMD_SET_CREATE(
     /* Alphabetically sorted. */
     SHELL_CMD(start, NULL, CMD_HELP_CALIBRATION_START, cmd_matrix_calibration_start),
     SHELL_CMD(export, NULL, CMD_HELP_CALIBRATION_EXPORT, cmd_matrix_calibration_export),
+    SHELL_CMD(import, NULL, CMD_HELP_CALIBRATION_IMPORT, cmd_matrix_calibration_import),
+    SHELL_CMD(skip, NULL, CMD_HELP_CALIBRATION_SKIP, cmd_matrix_calibration_skip),
 #if IS_ENABLED(CONFIG_SETTINGS)
     SHELL_CMD(save, NULL, CMD_HELP_CALIBRATION_SAVE, cmd_matrix_calibration_save),
     SHELL_CMD(load, NULL, CMD_HELP_CALIBRATION_LOAD, cmd_matrix_calibration_load),
@@ -226,13 +567,22 @@ SHELL_STATIC_SUBCMD_SET_CREATE(
 SHELL_STATIC_SUBCMD_SET_CREATE(
     sub_matrix_cmds,
     /* Alphabetically sorted. */
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+    SHELL_CMD(analog, NULL, CMD_HELP_ANALOG, cmd_matrix_analog),
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+    SHELL_CMD(boot_timing, NULL, CMD_HELP_BOOT_TIMING, cmd_matrix_boot_timing),
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
     SHELL_CMD(calibration, &sub_matrix_calibration_cmds, CMD_HELP_CALIBRATE, NULL),
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
     SHELL_CMD(scan_rate, NULL, CMD_HELP_SCAN_RATE, cmd_matrix_scan_rate),
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
     SHELL_CMD(read_timing, NULL, CMD_HELP_READ_TIMING, cmd_matrix_read_timing),
-#endif                   // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+    SHELL_CMD(trace, NULL, CMD_HELP_TRACE, cmd_matrix_trace),
+#endif                   // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
     SHELL_SUBCMD_SET_END /* Array terminated. */
 );
 
@@ -12,8 +12,13 @@
 #include <zephyr/drivers/kscan.h>
 #include <zephyr/drivers/pinctrl.h>
 #include <zephyr/pm/device.h>
+#include <zephyr/sys/math_extras.h>
 #include <zephyr/sys/util.h>
 
+#include <stdlib.h>
+
+#include "ec_matrix_bitset.h"
+#include "ec_matrix_calib_stats.h"
 #include "zmk_kscan_ec_matrix.h"
 
 #define LOG_LEVEL CONFIG_KSCAN_LOG_LEVEL
@@ -25,6 +30,25 @@ LOG_MODULE_REGISTER(zmk_kscan_ec_matrix);
 #include <zephyr/timing/timing.h>
 #endif
 
+// Order matches the debounce-policy enum in the binding.
+enum kscan_ec_matrix_debounce_policy {
+    DEBOUNCE_POLICY_TWO_SCAN,
+    DEBOUNCE_POLICY_EAGER_PRESS,
+    DEBOUNCE_POLICY_N_OF_M,
+    DEBOUNCE_POLICY_TIME,
+};
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+
+// A line resolved to its port and pin mask at build time, switched with a single raw port write.
+struct kscan_ec_matrix_raw_line {
+    const struct device *port;
+    gpio_port_pins_t pins;
+    bool active_low;
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+
 struct kscan_ec_matrix_config {
     const struct pinctrl_dev_config *pcfg;
     struct gpio_dt_spec power;
@@ -33,11 +57,26 @@ struct kscan_ec_matrix_config {
     const bool skip_startup_calibration;
     const uint8_t strobes_len;
     const uint8_t inputs_len;
+    // Words of each strobe's row in the key bitsets.
+    const uint8_t row_words;
+    // Words of each strobe's entry in strobe_input_masks.
+    const uint8_t mask_words;
     const uint8_t trigger_percentage;
+    const uint8_t confirm_reads;
+    const uint8_t debounce_policy;
+    const uint8_t debounce_votes;
+    const uint8_t debounce_window;
+    const uint32_t debounce_press_us;
+    const uint32_t debounce_release_us;
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+    const bool rapid_trigger;
+    const uint8_t rapid_trigger_press_percentage;
+    const uint8_t rapid_trigger_release_percentage;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
     const uint16_t matrix_warm_up_us;
     const uint16_t matrix_relax_us;
     const uint16_t adc_read_settle_us;
-    const uint16_t active_polling_interval_ms;
+    const uint32_t active_polling_interval_us;
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
     const uint16_t idle_polling_interval_ms;
     const uint16_t sleep_polling_interval_ms;
@@ -47,15 +86,80 @@ struct kscan_ec_matrix_config {
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
     const struct gpio_dt_spec *inputs;
     const uint32_t *strobe_input_masks;
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+    const struct kscan_ec_matrix_raw_line *raw_strobes;
+    const struct kscan_ec_matrix_raw_line raw_drain;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
     const struct gpio_dt_spec strobes[];
 };
 
+// Press/release limits in the raw ADC domain, derived from a calibration entry so the scan loop
+// does not need to normalize every sample.
+struct kscan_ec_matrix_threshold {
+    uint16_t press;
+    uint16_t release;
+    // Fixed point reciprocal of the calibrated range, so travel can be derived from a raw sample
+    // with a multiply instead of a divide.
+    uint16_t travel_low;
+    uint32_t travel_scale;
+    // Calibration the limits were derived from, see threshold_derived_from().
+    uint16_t calibrated_low;
+    uint16_t calibrated_high;
+    uint16_t noise_margin;
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+    uint16_t rapid_press_delta;
+    uint16_t rapid_release_delta;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+    // Released samples at or below this are treated as the key being at rest.
+    uint16_t rest_limit;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+};
+
+#define SAMPLE_COUNT 20
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
+
+enum kscan_ec_matrix_calibration_phase {
+    CALIBRATION_PHASE_IDLE,
+    CALIBRATION_PHASE_LOW,
+    CALIBRATION_PHASE_HIGH,
+};
+
+// Progress of a calibration, advanced by one sampling slot after each scan.
+struct kscan_ec_matrix_calibration_state {
+    enum kscan_ec_matrix_calibration_phase phase;
+    // Uptime in ms before which no slot is taken.
+    int64_t resume_at;
+    // Uptime in ms at which the keys left time out, or 0 for never.
+    int64_t deadline;
+    // Only the keys already set in calibration_pending are to be calibrated.
+    bool subset;
+    uint16_t keys_total;
+    uint16_t keys_to_complete;
+    uint16_t keys_low_remaining;
+};
+
+// Progress of one key during a calibration.
+struct kscan_ec_matrix_calibration_key {
+    struct ec_matrix_calib_stats stats;
+    // Uptime in ms the key went past the high threshold, or 0 while it is below it.
+    uint32_t pressed_at;
+    // Uptime in ms the high samples in stats started.
+    uint32_t plateau_at;
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
+
 struct kscan_ec_matrix_data {
     kscan_callback_t callback;
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
     uint32_t last_key_released_at;
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
-    uint16_t poll_interval;
+    uint32_t poll_interval_us;
+    uint32_t scan_overruns;
+    struct k_timer scan_timer;
+    struct k_sem scan_sem;
     struct k_thread thread;
     K_KERNEL_STACK_MEMBER(thread_stack, CONFIG_ZMK_KSCAN_EC_MATRIX_THREAD_STACK_SIZE);
     const struct device *dev;
@@ -63,16 +167,77 @@ struct kscan_ec_matrix_data {
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
     zmk_kscan_ec_matrix_calibration_cb_t calibration_callback;
     const void *calibration_user_data;
+    struct kscan_ec_matrix_calibration_state calibration;
+    struct kscan_ec_matrix_calibration_key *calibration_keys;
+    // Keys of each strobe the calibration has not completed, skipped or timed out yet.
+    uint64_t *calibration_pending;
+    // Receives the calibration in progress, swapped with calibrations once it completes.
+    struct zmk_kscan_ec_matrix_calibration_entry *calibration_shadow;
 #endif // IS_DEFINED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
     uint64_t max_scan_duration_ns;
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
+    // Cycle count at which the matrix was last returned to rest, with the drain pulled low.
+    uint32_t drain_pulled_at;
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
     struct zmk_kscan_ec_matrix_read_timing read_timing;
+    // Cycle count at which interrupts were last locked for a read.
+    uint32_t irq_locked_start;
+    // Longest window with interrupts locked of the scan in progress, in cycles.
+    uint32_t irq_locked_scan_cycles;
+    uint64_t irq_locked_max_ns;
+    // Relax time of the scan in progress that had already elapsed when a read started.
+    uint64_t relax_scan_saved_ns;
+    uint64_t relax_saved_ns;
 #endif
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+    struct zmk_kscan_ec_matrix_boot_timing boot_timing;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+    struct zmk_kscan_ec_matrix_trace_record *trace_records;
+    atomic_t trace_head;
+    atomic_t trace_tail;
+    atomic_t trace_dropped;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+    // Two frames of per-key travel, frame N lives in buffer N & 1.
+    uint16_t *analog_frames;
+    uint16_t *analog_back;
+    atomic_t analog_published;
+    atomic_t analog_writing;
+    // Frames left to begin by clearing the inactive keys, one per buffer once keys become
+    // inactive.
+    uint8_t analog_clear_frames;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+    uint32_t debounce_press_cycles;
+    uint32_t debounce_release_cycles;
+    // Packed per-key debounce state, see kscan_ec_matrix_debounce_key().
+    uint32_t *debounce_states;
+    // Keys of each strobe whose debounce state machine has not come to rest.
+    uint64_t *debounce_unsettled;
     struct zmk_kscan_ec_matrix_calibration_entry *calibrations;
+    struct kscan_ec_matrix_threshold *thresholds;
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+    // Deepest raw value while pressed, shallowest while released within rapid trigger range, or 0
+    // once the key has returned past its release limit.
+    uint16_t *rapid_extremums;
+    // Extremum of each key changing state in the scan in progress from before the change, restored
+    // if confirmation rejects the change.
+    uint16_t *rapid_extremums_before;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+    // Tracked rest level of each key in fixed point with BASELINE_FRACTION_BITS fraction bits.
+    int32_t *baselines;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+    // Inputs of each strobe that are unmasked and have a usable calibration.
+    uint64_t *active_inputs;
+    // Inputs and strobes in the order scans visit them, see kscan_ec_matrix_plan_order().
+    uint8_t *input_order;
+    uint8_t *strobe_order;
+    uint8_t input_order_len;
+    uint8_t strobe_order_len;
     uint64_t *reported_matrix_state;
-    uint64_t matrix_state[];
+    uint64_t *matrix_state;
 };
 
 static int kscan_ec_matrix_configure(const struct device *dev, kscan_callback_t callback) {
@@ -88,12 +253,15 @@ static int kscan_ec_matrix_enable(const struct device *dev) {
     const struct kscan_ec_matrix_config *cfg = dev->config;
     struct kscan_ec_matrix_data *data = dev->data;
 
-    data->poll_interval = cfg->active_polling_interval_ms;
+    data->poll_interval_us = cfg->active_polling_interval_us;
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
     data->last_key_released_at = k_uptime_get();
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
 
+    k_timer_start(&data->scan_timer, K_USEC(data->poll_interval_us),
+                  K_USEC(data->poll_interval_us));
+
     k_mutex_unlock(&data->mutex);
 
     return 0;
@@ -102,6 +270,7 @@ static int kscan_ec_matrix_enable(const struct device *dev) {
 static int kscan_ec_matrix_disable(const struct device *dev) {
     struct kscan_ec_matrix_data *data = dev->data;
 
+    k_timer_stop(&data->scan_timer);
     k_mutex_lock(&data->mutex, K_MSEC(30));
 
     return 0;
@@ -115,8 +284,114 @@ calibration_entry_for_strobe_input(const struct device *dev, uint8_t strobe, uin
     return &data->calibrations[(strobe * cfg->inputs_len) + input];
 }
 
+// Row of one strobe in a bitset with a bit per key, e.g. matrix_state.
+static inline uint64_t *strobe_row(const struct kscan_ec_matrix_config *cfg, uint64_t *rows,
+                                   uint8_t strobe) {
+    return &rows[strobe * cfg->row_words];
+}
+
+static inline bool input_masked(const struct kscan_ec_matrix_config *cfg, uint8_t strobe,
+                                uint8_t input) {
+    return cfg->strobe_input_masks &&
+           (cfg->strobe_input_masks[(strobe * cfg->mask_words) + (input / 32)] &
+            BIT(input % 32)) != 0;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+
+static inline void raw_line_set(const struct kscan_ec_matrix_raw_line *line, bool active) {
+    if (active != line->active_low) {
+        gpio_port_set_bits_raw(line->port, line->pins);
+    } else {
+        gpio_port_clear_bits_raw(line->port, line->pins);
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+
+static inline void set_strobe(const struct kscan_ec_matrix_config *cfg, uint8_t strobe,
+                              bool active) {
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+    raw_line_set(&cfg->raw_strobes[strobe], active);
+#else
+    gpio_pin_set_dt(&cfg->strobes[strobe], active);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+}
+
+static inline void release_drain(const struct kscan_ec_matrix_config *cfg) {
+    if (cfg->drain.port != NULL) {
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_FAKE_OPEN_DRAIN)
+        gpio_pin_configure_dt(&cfg->drain, GPIO_INPUT);
+#elif IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+        raw_line_set(&cfg->raw_drain, true);
+#else
+        gpio_pin_set_dt(&cfg->drain, 1);
+#endif
+    }
+}
+
+static inline void pull_drain(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    if (cfg->drain.port != NULL) {
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_FAKE_OPEN_DRAIN)
+        gpio_pin_configure_dt(&cfg->drain, GPIO_OUTPUT);
+        gpio_pin_set_dt(&cfg->drain, 0);
+#elif IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO)
+        raw_line_set(&cfg->raw_drain, false);
+#else
+        gpio_pin_set_dt(&cfg->drain, 0);
+#endif
+    }
+
+    data->drain_pulled_at = k_cycle_get_32();
+}
+
+// Waits out whatever is left of matrix-relax-us since the drain was last pulled low. A cycle
+// counter wrap during a long idle only makes this wait longer than needed.
+static inline void relax_matrix(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    if (cfg->matrix_relax_us == 0) {
+        return;
+    }
+
+    uint32_t relaxed_us = k_cyc_to_us_floor32(k_cycle_get_32() - data->drain_pulled_at);
+    if (relaxed_us < cfg->matrix_relax_us) {
+        k_busy_wait(cfg->matrix_relax_us - relaxed_us);
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+    data->relax_scan_saved_ns += (uint64_t)MIN(relaxed_us, cfg->matrix_relax_us) * NSEC_PER_USEC;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+}
+
+// Locks interrupts for the timing critical part of a read, tracking the longest locked window of
+// each scan.
+static inline uint32_t read_irq_lock(struct kscan_ec_matrix_data *data) {
+    const uint32_t lock = irq_lock();
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+    data->irq_locked_start = k_cycle_get_32();
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+
+    return lock;
+}
+
+static inline void read_irq_unlock(struct kscan_ec_matrix_data *data, uint32_t lock) {
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+    data->irq_locked_scan_cycles =
+        MAX(data->irq_locked_scan_cycles, k_cycle_get_32() - data->irq_locked_start);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+
+    irq_unlock(lock);
+}
+
 static uint16_t read_raw_matrix_state(const struct device *dev, uint8_t strobe, uint8_t input) {
     const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
     int ret;
 
     int16_t buf = 0;
@@ -126,8 +401,6 @@ static uint16_t read_raw_matrix_state(const struct device *dev, uint8_t strobe,
     };
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
-    struct kscan_ec_matrix_data *data = dev->data;
-
     timing_start();
     timing_t start_time = timing_counter_get();
 #endif
@@ -147,30 +420,21 @@ static uint16_t read_raw_matrix_state(const struct device *dev, uint8_t strobe,
     timing_t gpio_input_done = timing_counter_get();
 #endif
 
-    // TODO: Only wait as long as is need after drain pin was set low.
-    if (cfg->matrix_relax_us > 0) {
-        k_busy_wait(cfg->matrix_relax_us);
-    }
+    relax_matrix(dev);
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
     timing_t relax_done = timing_counter_get();
 #endif
 
-    const uint32_t lock = irq_lock();
+    const uint32_t lock = read_irq_lock(data);
 
-    if (cfg->drain.port != NULL) {
-#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_FAKE_OPEN_DRAIN)
-        gpio_pin_configure_dt(&cfg->drain, GPIO_INPUT);
-#else
-        gpio_pin_set_dt(&cfg->drain, 1);
-#endif
-    }
+    release_drain(cfg);
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
     timing_t drain_released_done = timing_counter_get();
 #endif
 
-    gpio_pin_set_dt(&cfg->strobes[strobe], 1);
+    set_strobe(cfg, strobe, true);
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
     timing_t set_strobe_done = timing_counter_get();
@@ -182,29 +446,25 @@ static uint16_t read_raw_matrix_state(const struct device *dev, uint8_t strobe,
     timing_t adc_read_settle_done = timing_counter_get();
 #endif
 
+    // Only the edge and settling need to be deterministic, the conversion may be interrupted.
+    read_irq_unlock(data, lock);
+
     ret = adc_read(cfg->adc_channel.dev, &sequence);
     if (ret < 0) {
         LOG_ERR("ADC READ ERROR %d", ret);
     }
 
-    irq_unlock(lock);
-
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
     timing_t adc_read_done = timing_counter_get();
 #endif
 
-    gpio_pin_set_dt(&cfg->strobes[strobe], 0);
+    set_strobe(cfg, strobe, false);
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
     timing_t strobe_unset_done = timing_counter_get();
 #endif
 
-    if (cfg->drain.port != NULL) {
-#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_FAKE_OPEN_DRAIN)
-        gpio_pin_configure_dt(&cfg->drain, GPIO_OUTPUT);
-#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_FAKE_OPEN_DRAIN)
-        gpio_pin_set_dt(&cfg->drain, 0);
-    }
+    pull_drain(dev);
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
     timing_t drain_unset_done = timing_counter_get();
@@ -239,334 +499,1466 @@ static uint16_t read_raw_matrix_state(const struct device *dev, uint8_t strobe,
     };
 #endif
 
-    return buf;
+    return buf;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_BATCHED)
+
+struct batched_read_context {
+    const struct device *dev;
+    const uint8_t *strobes;
+    uint8_t strobes_len;
+};
+
+// Called by the ADC driver after each sampling of a batched sequence, possibly from ISR context.
+// Moves the matrix from the strobe just sampled to the next one before the next sampling starts.
+// The busy-waits here are matrix-relax-us plus adc-read-settle-us per strobe, capped at build
+// time by CONFIG_ZMK_KSCAN_EC_MATRIX_BATCHED_MAX_STROBE_WAIT_US, and only plain pin writes are
+// made.
+static enum adc_action batched_read_sampling_done(const struct device *adc_dev,
+                                                  const struct adc_sequence *sequence,
+                                                  uint16_t sampling_index) {
+    const struct batched_read_context *ctx = sequence->options->user_data;
+    const struct kscan_ec_matrix_config *cfg = ctx->dev->config;
+
+    set_strobe(cfg, ctx->strobes[sampling_index], false);
+    pull_drain(ctx->dev);
+
+    if (sampling_index + 1 >= ctx->strobes_len) {
+        return ADC_ACTION_FINISH;
+    }
+
+    relax_matrix(ctx->dev);
+
+    // The sequence runs with interrupts enabled, so only this edge is locked.
+    const uint32_t lock = read_irq_lock(ctx->dev->data);
+
+    release_drain(cfg);
+    set_strobe(cfg, ctx->strobes[sampling_index + 1], true);
+    k_busy_wait(cfg->adc_read_settle_us);
+
+    read_irq_unlock(ctx->dev->data, lock);
+
+    return ADC_ACTION_CONTINUE;
+}
+
+// Reads every listed strobe of one input in a single ADC sequence, storing one raw value per
+// strobe in bufs.
+static void read_raw_input_strobes(const struct device *dev, uint8_t input, const uint8_t *strobes,
+                                   uint8_t strobes_len, int16_t *bufs) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    int ret;
+
+    struct batched_read_context ctx = {
+        .dev = dev,
+        .strobes = strobes,
+        .strobes_len = strobes_len,
+    };
+    struct adc_sequence_options options = {
+        .callback = batched_read_sampling_done,
+        .user_data = &ctx,
+        .extra_samplings = strobes_len - 1,
+    };
+    struct adc_sequence sequence = {
+        .options = &options,
+        .buffer = bufs,
+        .buffer_size = strobes_len * sizeof(int16_t),
+    };
+
+    adc_sequence_init_dt(&cfg->adc_channel, &sequence);
+
+    ret = gpio_pin_configure_dt(&cfg->inputs[input], GPIO_INPUT);
+    if (ret < 0) {
+        LOG_ERR("Failed to set the input pin (%d)", ret);
+    }
+
+    relax_matrix(dev);
+
+    const uint32_t lock = read_irq_lock(data);
+
+    release_drain(cfg);
+    set_strobe(cfg, strobes[0], true);
+    k_busy_wait(cfg->adc_read_settle_us);
+
+    read_irq_unlock(data, lock);
+
+    ret = adc_read(cfg->adc_channel.dev, &sequence);
+    if (ret < 0) {
+        LOG_ERR("ADC READ ERROR %d", ret);
+
+        // The sequence may have stopped before the callback unset the current strobe.
+        for (int i = 0; i < strobes_len; i++) {
+            set_strobe(cfg, strobes[i], false);
+        }
+        pull_drain(dev);
+    }
+
+    gpio_pin_configure_dt(&cfg->inputs[input], GPIO_DISCONNECTED);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_BATCHED)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_ASYNC)
+
+struct async_read {
+    struct adc_sequence sequence;
+    struct k_poll_signal signal;
+    uint32_t settle_start;
+    int16_t buf;
+    uint8_t strobe;
+    uint8_t input;
+};
+
+// Selects the input and raises the strobe for a key, once the matrix has relaxed.
+static void arm_raw_matrix_read(const struct device *dev, struct async_read *read, uint8_t strobe,
+                                uint8_t input) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    int ret;
+
+    read->strobe = strobe;
+    read->input = input;
+    read->buf = 0;
+    read->sequence = (struct adc_sequence){
+        .buffer = &read->buf,
+        .buffer_size = sizeof(read->buf),
+    };
+
+    adc_sequence_init_dt(&cfg->adc_channel, &read->sequence);
+
+    ret = gpio_pin_configure_dt(&cfg->inputs[input], GPIO_INPUT);
+    if (ret < 0) {
+        LOG_ERR("Failed to set the input pin (%d)", ret);
+    }
+
+    relax_matrix(dev);
+
+    const uint32_t lock = read_irq_lock(data);
+
+    release_drain(cfg);
+    set_strobe(cfg, strobe, true);
+    read->settle_start = k_cycle_get_32();
+
+    read_irq_unlock(data, lock);
+}
+
+// Waits out whatever is left of the settle time and starts the conversion without blocking.
+static void fire_raw_matrix_read(const struct device *dev, struct async_read *read) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+
+    uint32_t settled_us = k_cyc_to_us_floor32(k_cycle_get_32() - read->settle_start);
+    if (settled_us < cfg->adc_read_settle_us) {
+        k_busy_wait(cfg->adc_read_settle_us - settled_us);
+    }
+
+    k_poll_signal_reset(&read->signal);
+
+    int ret = adc_read_async(cfg->adc_channel.dev, &read->sequence, &read->signal);
+    if (ret < 0) {
+        LOG_ERR("ADC READ ERROR %d", ret);
+        k_poll_signal_raise(&read->signal, ret);
+    }
+}
+
+// Blocks until the conversion started by fire_raw_matrix_read completes, yielding the CPU to other
+// threads meanwhile, then returns the matrix to rest.
+static uint16_t finish_raw_matrix_read(const struct device *dev, struct async_read *read) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct k_poll_event event =
+        K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &read->signal);
+
+    k_poll(&event, 1, K_FOREVER);
+
+    unsigned int signaled;
+    int result;
+    k_poll_signal_check(&read->signal, &signaled, &result);
+    if (result < 0) {
+        read->buf = 0;
+    }
+
+    set_strobe(cfg, read->strobe, false);
+    pull_drain(dev);
+    gpio_pin_configure_dt(&cfg->inputs[read->input], GPIO_DISCONNECTED);
+
+    return read->buf;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_ASYNC)
+
+uint16_t normalize(uint16_t val, uint16_t avg_low, uint16_t avg_high) {
+    val = MAX(val, avg_low);
+    val = MIN(val, avg_high);
+
+    uint32_t numerator = UINT16_MAX * (val - avg_low);
+    uint16_t denominator = avg_high - avg_low;
+
+    return (uint16_t)(numerator / denominator);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+
+#define BASELINE_FRACTION_BITS 12
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+
+// Multiple of the noise sigma kept as margin, exceeded by about 0.3% of gaussian noise samples.
+#define NOISE_SIGMA_MARGIN 3
+
+BUILD_ASSERT(EC_MATRIX_CALIB_STATS_SIGMA_FRACTION_BITS ==
+             ZMK_KSCAN_EC_MATRIX_NOISE_SIGMA_FRACTION_BITS);
+
+// Noise margin of one key, derived from its noise sigma when the calibration measured it and
+// from the peak to peak noise of older calibrations otherwise.
+static inline uint16_t
+noise_margin(const struct zmk_kscan_ec_matrix_calibration_entry *calibration) {
+    if (calibration->noise_sigma == 0) {
+        return calibration->noise;
+    }
+
+    return DIV_ROUND_UP(NOISE_SIGMA_MARGIN * calibration->noise_sigma,
+                        BIT(ZMK_KSCAN_EC_MATRIX_NOISE_SIGMA_FRACTION_BITS));
+}
+
+// Derives the limits of one key from its calibration, using avg_low as the rest level so a
+// tracked baseline can stand in for the calibrated one.
+static void compute_threshold(const struct kscan_ec_matrix_config *cfg,
+                              const struct zmk_kscan_ec_matrix_calibration_entry *calibration,
+                              uint16_t avg_low, struct kscan_ec_matrix_threshold *threshold) {
+    uint32_t range = calibration->avg_high - avg_low;
+    uint16_t noise = noise_margin(calibration);
+    uint32_t press_offset = MIN(MAX((range * cfg->trigger_percentage) / 100, noise), range);
+    uint32_t hys_buffer = MAX(range / 8, noise);
+
+    threshold->press = calibration->avg_high - press_offset;
+    threshold->release =
+        (threshold->press - avg_low > hys_buffer) ? threshold->press - hys_buffer : avg_low;
+    threshold->travel_low = avg_low;
+    threshold->travel_scale = ((uint32_t)UINT16_MAX << 16) / range;
+    threshold->calibrated_low = calibration->avg_low;
+    threshold->calibrated_high = calibration->avg_high;
+    threshold->noise_margin = noise;
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+    threshold->rapid_press_delta = MAX((range * cfg->rapid_trigger_press_percentage) / 100, noise);
+    threshold->rapid_release_delta =
+        MAX((range * cfg->rapid_trigger_release_percentage) / 100, noise);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+    threshold->rest_limit = MIN(avg_low + MAX(range / 16, noise), threshold->release);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+static void analog_frame_clear_inactive(const struct device *dev);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+
+// Whether a threshold was derived from the given calibration, in which case the limits and the
+// state tracked for the key are still valid.
+static inline bool
+threshold_derived_from(const struct kscan_ec_matrix_threshold *threshold,
+                       const struct zmk_kscan_ec_matrix_calibration_entry *calibration) {
+    return threshold->calibrated_low == calibration->avg_low &&
+           threshold->calibrated_high == calibration->avg_high &&
+           threshold->noise_margin == noise_margin(calibration);
+}
+
+// Re-derives the limits of every key whose calibration changed. Keys whose calibration did not
+// change keep their limits, tracked baseline and rapid trigger state, as they may be held.
+static void kscan_ec_matrix_update_thresholds(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    bool deactivated = false;
+
+    for (int s = 0; s < cfg->strobes_len; s++) {
+        uint64_t *active = strobe_row(cfg, data->active_inputs, s);
+
+        for (int i = 0; i < cfg->inputs_len; i++) {
+            const struct zmk_kscan_ec_matrix_calibration_entry *calibration =
+                calibration_entry_for_strobe_input(dev, s, i);
+            uint16_t p = (s * cfg->inputs_len) + i;
+            bool was_active = ec_matrix_bitset_test(active, i);
+
+            if (input_masked(cfg, s, i) || calibration->avg_high <= calibration->avg_low) {
+                ec_matrix_bitset_clear(active, i);
+                deactivated = deactivated || was_active;
+                continue;
+            }
+
+            ec_matrix_bitset_set(active, i);
+
+            if (was_active && threshold_derived_from(&data->thresholds[p], calibration)) {
+                continue;
+            }
+
+            compute_threshold(cfg, calibration, calibration->avg_low, &data->thresholds[p]);
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+            data->baselines[p] = calibration->avg_low << BASELINE_FRACTION_BITS;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+            data->rapid_extremums[p] = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+        }
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+    // Keys that just became inactive are no longer written by the scan.
+    if (deactivated) {
+        analog_frame_clear_inactive(dev);
+    }
+#else
+    ARG_UNUSED(deactivated);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+}
+
+// Equivalent to normalize() against the calibration the threshold was derived from.
+static inline uint16_t threshold_travel(const struct kscan_ec_matrix_threshold *threshold,
+                                        uint16_t val) {
+    if (val <= threshold->travel_low) {
+        return 0;
+    }
+
+    uint64_t travel = ((uint64_t)(val - threshold->travel_low) * threshold->travel_scale) >> 16;
+
+    return (uint16_t)MIN(travel, UINT16_MAX);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
+
+// Delay between the start of a calibration and its first low sample, leaving time to release
+// the keys.
+#define CALIBRATION_LOW_SETTLE_MS 1000
+
+static inline bool calibration_position_masked(const struct kscan_ec_matrix_config *cfg,
+                                               uint16_t position) {
+    return input_masked(cfg, position / cfg->inputs_len, position % cfg->inputs_len);
+}
+
+static inline void calibration_notify(struct kscan_ec_matrix_data *data,
+                                      const struct zmk_kscan_ec_matrix_calibration_event *ev) {
+    if (data->calibration_callback) {
+        data->calibration_callback(ev, data->calibration_user_data);
+    }
+}
+
+static void calibration_begin(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    struct kscan_ec_matrix_calibration_state *cal = &data->calibration;
+    int64_t now = k_uptime_get();
+
+    // Masked positions and the ones left out of a subset keep their current entries.
+    memcpy(data->calibration_shadow, data->calibrations,
+           cfg->strobes_len * cfg->inputs_len * sizeof(data->calibrations[0]));
+
+    cal->phase = CALIBRATION_PHASE_LOW;
+    cal->resume_at = now + CALIBRATION_LOW_SETTLE_MS;
+    cal->deadline = CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_TIMEOUT_SECS > 0
+                        ? now + (CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_TIMEOUT_SECS * MSEC_PER_SEC)
+                        : 0;
+    cal->keys_total = 0;
+
+    for (uint8_t s = 0; s < cfg->strobes_len; s++) {
+        uint64_t *pending = strobe_row(cfg, data->calibration_pending, s);
+
+        for (uint8_t i = 0; i < cfg->inputs_len; i++) {
+            uint16_t p = (s * cfg->inputs_len) + i;
+            bool requested = !cal->subset || ec_matrix_bitset_test(pending, i);
+
+            if (!requested || calibration_position_masked(cfg, p)) {
+                ec_matrix_bitset_clear(pending, i);
+                continue;
+            }
+
+            ec_matrix_bitset_set(pending, i);
+            ec_matrix_calib_stats_reset(&data->calibration_keys[p].stats);
+            cal->keys_total++;
+        }
+    }
+
+    cal->keys_to_complete = cal->keys_total;
+    cal->keys_low_remaining = cal->keys_total;
+
+    struct zmk_kscan_ec_matrix_calibration_event ev = {.type = CALIBRATION_EV_LOW_SAMPLING_START,
+                                                       .data = {}};
+    calibration_notify(data, &ev);
+}
+
+static void calibration_resolve(const struct device *dev, uint8_t strobe, uint8_t input) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    struct kscan_ec_matrix_calibration_state *cal = &data->calibration;
+
+    // Keys given up on during the low phase no longer hold it up.
+    if (cal->phase == CALIBRATION_PHASE_LOW &&
+        data->calibration_keys[(strobe * cfg->inputs_len) + input].stats.count < SAMPLE_COUNT) {
+        cal->keys_low_remaining--;
+    }
+
+    ec_matrix_bitset_clear(strobe_row(cfg, data->calibration_pending, strobe), input);
+    cal->keys_to_complete--;
+
+    struct zmk_kscan_ec_matrix_calibration_event ev = {
+        .type = CALIBRATION_EV_PROGRESS,
+        .data = {.progress = {.completed = cal->keys_total - cal->keys_to_complete,
+                              .total = cal->keys_total}}};
+    calibration_notify(data, &ev);
+}
+
+// Gives up on one key, which keeps its previous calibration.
+static void calibration_abandon(const struct device *dev, uint8_t strobe, uint8_t input,
+                                enum zmk_kscan_ec_matrix_calibration_event_type type) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    struct zmk_kscan_ec_matrix_calibration_event ev = {
+        .type = type, .data = {.position_skipped = {.strobe = strobe, .input = input}}};
+    calibration_notify(data, &ev);
+
+    calibration_resolve(dev, strobe, input);
+}
+
+static void calibration_abandon_all(const struct device *dev,
+                                    enum zmk_kscan_ec_matrix_calibration_event_type type) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    for (uint8_t s = 0; s < cfg->strobes_len; s++) {
+        for (uint8_t w = 0; w < cfg->row_words; w++) {
+            for (uint64_t pending = strobe_row(cfg, data->calibration_pending, s)[w];
+                 pending != 0; pending &= pending - 1) {
+                uint8_t i = (w * EC_MATRIX_BITSET_WORD_BITS) + u64_count_trailing_zeros(pending);
+
+                calibration_abandon(dev, s, i, type);
+            }
+        }
+    }
+}
+
+static void calibration_finish(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    struct zmk_kscan_ec_matrix_calibration_entry *previous = data->calibrations;
+
+    // Keys skipped or timed out before reaching a high value keep their previous entries.
+    for (uint16_t p = 0; p < cfg->strobes_len * cfg->inputs_len; p++) {
+        if (data->calibration_shadow[p].avg_high == 0) {
+            data->calibration_shadow[p] = previous[p];
+        }
+    }
+
+    // Scans only run on this thread, so they switch over between two reads.
+    data->calibrations = data->calibration_shadow;
+    data->calibration_shadow = previous;
+    data->calibration.phase = CALIBRATION_PHASE_IDLE;
+
+    kscan_ec_matrix_update_thresholds(dev);
+
+    struct zmk_kscan_ec_matrix_calibration_event ev = {
+        .type = CALIBRATION_EV_COMPLETE,
+    };
+    calibration_notify(data, &ev);
+
+    data->calibration_callback = NULL;
+    data->calibration_user_data = NULL;
+}
+
+// Takes one low sample of a key, determining its low value once it has enough of them.
+static void calibration_sample_low(const struct device *dev, uint8_t s, uint8_t i) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    uint16_t p = (s * cfg->inputs_len) + i;
+    struct ec_matrix_calib_stats *res = &data->calibration_keys[p].stats;
+
+    if (res->count >= SAMPLE_COUNT) {
+        return;
+    }
+
+    // A pressed key would skew its rest level, so sample it again once released.
+    if (ec_matrix_bitset_test(strobe_row(cfg, data->matrix_state, s), i)) {
+        ec_matrix_calib_stats_reset(res);
+        return;
+    }
+
+    ec_matrix_calib_stats_add(res, read_raw_matrix_state(dev, s, i));
+
+    if (res->count < SAMPLE_COUNT) {
+        return;
+    }
+
+    uint16_t avg = ec_matrix_calib_stats_mean(res);
+    uint16_t noise = ec_matrix_calib_stats_range(res);
+    uint16_t sigma = ec_matrix_calib_stats_sigma(res);
+
+    LOG_DBG("Low avg for %d,%d using %d and %d is %d. Noise %d, sigma %d/%lu", s, i, res->max,
+            res->min, avg, noise, sigma, BIT(ZMK_KSCAN_EC_MATRIX_NOISE_SIGMA_FRACTION_BITS));
+
+    data->calibration_shadow[p] = (struct zmk_kscan_ec_matrix_calibration_entry){
+        .avg_low = avg,
+        .noise = noise,
+        .noise_sigma = sigma,
+    };
+
+    struct zmk_kscan_ec_matrix_calibration_event ev = {
+        .type = CALIBRATION_EV_POSITION_LOW_DETERMINED,
+        .data = {.position_low_determined = {
+                     .low_avg = avg, .strobe = s, .input = i, .noise = noise}}};
+    calibration_notify(data, &ev);
+
+    data->calibration.keys_low_remaining--;
+}
+
+// Takes one low sample round across the whole matrix.
+static void calibration_step_low(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    struct kscan_ec_matrix_calibration_state *cal = &data->calibration;
+
+    for (uint8_t s = 0; s < cfg->strobes_len; s++) {
+        for (uint8_t w = 0; w < cfg->row_words; w++) {
+            for (uint64_t pending = strobe_row(cfg, data->calibration_pending, s)[w];
+                 pending != 0; pending &= pending - 1) {
+                uint8_t i = (w * EC_MATRIX_BITSET_WORD_BITS) + u64_count_trailing_zeros(pending);
+
+                calibration_sample_low(dev, s, i);
+            }
+        }
+    }
+
+    if (cal->keys_low_remaining > 0) {
+        return;
+    }
+
+    for (uint16_t p = 0; p < cfg->strobes_len * cfg->inputs_len; p++) {
+        data->calibration_keys[p].pressed_at = 0;
+    }
+
+    cal->phase = CALIBRATION_PHASE_HIGH;
+
+    struct zmk_kscan_ec_matrix_calibration_event ev = {.type = CALIBRATION_EV_HIGH_SAMPLING_START,
+                                                       .data = {}};
+    calibration_notify(data, &ev);
+}
+
+static void calibration_complete_high(const struct device *dev, uint8_t s, uint8_t i) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    uint16_t p = (s * cfg->inputs_len) + i;
+    const struct ec_matrix_calib_stats *res = &data->calibration_keys[p].stats;
+    struct zmk_kscan_ec_matrix_calibration_entry *calibration = &data->calibration_shadow[p];
+    uint16_t avg = ec_matrix_calib_stats_mean(res);
+
+    // Rough approximation of SNR by using avg difference + noise over noise
+    uint16_t snr = (avg - calibration->avg_low + calibration->noise) / MAX(calibration->noise, 1);
+    LOG_DBG("High avg for %d,%d is %d after %d samples. SNR %d", s, i, avg, res->count, snr);
+
+    calibration->avg_high = avg;
+    calibration->noise = MAX(calibration->noise, ec_matrix_calib_stats_range(res));
+    calibration->noise_sigma = MAX(calibration->noise_sigma, ec_matrix_calib_stats_sigma(res));
+
+    struct zmk_kscan_ec_matrix_calibration_event ev = {
+        .type = CALIBRATION_EV_POSITION_COMPLETE,
+        .data = {.position_complete = {.high_avg = calibration->avg_high,
+                                       .snr = snr,
+                                       .low_avg = calibration->avg_low,
+                                       .strobe = s,
+                                       .input = i,
+                                       .noise = calibration->noise}}};
+    calibration_notify(data, &ev);
+
+    calibration_resolve(dev, s, i);
+}
+
+// Takes one high sample of a key, completing it once its samples have stayed on a plateau for
+// long enough.
+static void calibration_sample_high(const struct device *dev, uint8_t s, uint8_t i, uint32_t now) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    uint16_t p = (s * cfg->inputs_len) + i;
+    struct kscan_ec_matrix_calibration_key *key = &data->calibration_keys[p];
+    uint16_t val = read_raw_matrix_state(dev, s, i);
+
+    // Set the high threshold to half the full range possible
+    uint16_t high_threshold = BIT(cfg->adc_channel.resolution - 1);
+    uint16_t min_tolerance = MAX(BIT(cfg->adc_channel.resolution) / 256, 1);
+
+    if (val < high_threshold) {
+        key->pressed_at = 0;
+        return;
+    }
+
+    if (key->pressed_at == 0) {
+        key->pressed_at = now;
+        key->plateau_at = now;
+        ec_matrix_calib_stats_reset(&key->stats);
+    } else if (now - key->pressed_at >= CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_KEY_TIMEOUT_MS) {
+        LOG_WRN("Key %d,%d never settled on a high value", s, i);
+        calibration_abandon(dev, s, i, CALIBRATION_EV_POSITION_TIMEOUT);
+        return;
+    }
+
+    // A sample away from the mean means the key is still travelling, so the plateau starts over.
+    uint16_t tolerance = MAX(2 * noise_margin(&data->calibration_shadow[p]), min_tolerance);
+
+    if (key->stats.count > 0 &&
+        abs((int)val - (int)ec_matrix_calib_stats_mean(&key->stats)) > tolerance) {
+        key->plateau_at = now;
+        ec_matrix_calib_stats_reset(&key->stats);
+    }
+
+    ec_matrix_calib_stats_add(&key->stats, val);
+
+    if (key->stats.count >= SAMPLE_COUNT &&
+        now - key->plateau_at >= CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATION_PLATEAU_MS) {
+        calibration_complete_high(dev, s, i);
+    }
+}
+
+// Reads every key still waiting for its high value once, so any number of keys can be pressed at
+// the same time.
+static void calibration_step_high(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    uint32_t now = k_uptime_get_32();
+
+    for (uint8_t s = 0; s < cfg->strobes_len; s++) {
+        for (uint8_t w = 0; w < cfg->row_words; w++) {
+            for (uint64_t pending = strobe_row(cfg, data->calibration_pending, s)[w];
+                 pending != 0; pending &= pending - 1) {
+                uint8_t i = (w * EC_MATRIX_BITSET_WORD_BITS) + u64_count_trailing_zeros(pending);
+
+                calibration_sample_high(dev, s, i, now);
+            }
+        }
+    }
+}
+
+// Takes one sampling slot of the calibration in progress. Slots run right after a scan, so the
+// keyboard keeps reporting keys with the previous calibration until the new one is swapped in.
+static void calibration_step(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+    struct kscan_ec_matrix_calibration_state *cal = &data->calibration;
+    int64_t now = k_uptime_get();
+
+    if (now < cal->resume_at) {
+        return;
+    }
+
+    if (cal->deadline != 0 && now >= cal->deadline) {
+        LOG_WRN("Calibration timed out with %d keys left", cal->keys_to_complete);
+        calibration_abandon_all(dev, CALIBRATION_EV_POSITION_TIMEOUT);
+        calibration_finish(dev);
+        return;
+    }
+
+    if (cfg->power.port) {
+        gpio_pin_set_dt(&cfg->power, 1);
+        k_busy_wait(cfg->matrix_warm_up_us);
+    }
+
+    if (cal->phase == CALIBRATION_PHASE_LOW) {
+        calibration_step_low(dev);
+    } else {
+        calibration_step_high(dev);
+    }
+
+    if (cfg->power.port) {
+        gpio_pin_set_dt(&cfg->power, 0);
+    }
+
+    if (cal->phase == CALIBRATION_PHASE_HIGH && cal->keys_to_complete == 0) {
+        calibration_finish(dev);
+    }
+}
+
+int zmk_kscan_ec_matrix_calibrate(const struct device *dev,
+                                  zmk_kscan_ec_matrix_calibration_cb_t callback,
+                                  const void *user_data) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    int ret = k_mutex_lock(&data->mutex, K_SECONDS(1));
+
+    if (ret < 0) {
+        return -EAGAIN;
+    }
+
+    data->calibration_callback = callback;
+    data->calibration_user_data = user_data;
+    // Restarts a calibration already in progress on the next scan.
+    data->calibration.phase = CALIBRATION_PHASE_IDLE;
+    data->calibration.subset = false;
+
+    k_mutex_unlock(&data->mutex);
+
+    return 0;
+}
+
+int zmk_kscan_ec_matrix_calibrate_positions(const struct device *dev,
+                                            const struct zmk_kscan_ec_matrix_position *positions,
+                                            size_t len,
+                                            zmk_kscan_ec_matrix_calibration_cb_t callback,
+                                            const void *user_data) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    if (len == 0) {
+        return -EINVAL;
+    }
+
+    for (size_t k = 0; k < len; k++) {
+        if (positions[k].strobe >= cfg->strobes_len || positions[k].input >= cfg->inputs_len ||
+            calibration_position_masked(
+                cfg, (positions[k].strobe * cfg->inputs_len) + positions[k].input)) {
+            return -EINVAL;
+        }
+    }
+
+    int ret = k_mutex_lock(&data->mutex, K_SECONDS(1));
+
+    if (ret < 0) {
+        return -EAGAIN;
+    }
+
+    memset(data->calibration_pending, 0,
+           cfg->strobes_len * cfg->row_words * sizeof(data->calibration_pending[0]));
+
+    for (size_t k = 0; k < len; k++) {
+        ec_matrix_bitset_set(strobe_row(cfg, data->calibration_pending, positions[k].strobe),
+                             positions[k].input);
+    }
+
+    data->calibration_callback = callback;
+    data->calibration_user_data = user_data;
+    // Restarts a calibration already in progress on the next scan.
+    data->calibration.phase = CALIBRATION_PHASE_IDLE;
+    data->calibration.subset = true;
+
+    k_mutex_unlock(&data->mutex);
+
+    return 0;
+}
+
+int zmk_kscan_ec_matrix_calibration_skip(const struct device *dev, uint8_t strobe, uint8_t input) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    if (strobe >= cfg->strobes_len || input >= cfg->inputs_len) {
+        return -EINVAL;
+    }
+
+    int ret = k_mutex_lock(&data->mutex, K_SECONDS(1));
+
+    if (ret < 0) {
+        return -EAGAIN;
+    }
+
+    if (data->calibration.phase == CALIBRATION_PHASE_IDLE ||
+        !ec_matrix_bitset_test(strobe_row(cfg, data->calibration_pending, strobe), input)) {
+        ret = -ENOENT;
+    } else {
+        calibration_abandon(dev, strobe, input, CALIBRATION_EV_POSITION_SKIPPED);
+    }
+
+    k_mutex_unlock(&data->mutex);
+
+    return ret;
+}
+
+int zmk_kscan_ec_matrix_calibration_skip_remaining(const struct device *dev) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    int ret = k_mutex_lock(&data->mutex, K_SECONDS(1));
+
+    if (ret < 0) {
+        return -EAGAIN;
+    }
+
+    if (data->calibration.phase == CALIBRATION_PHASE_IDLE) {
+        ret = -ENOENT;
+    } else {
+        calibration_abandon_all(dev, CALIBRATION_EV_POSITION_SKIPPED);
+    }
+
+    k_mutex_unlock(&data->mutex);
+
+    return ret;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
+
+int zmk_kscan_ec_matrix_try_access_calibration(const struct device *dev,
+                                               zmk_kscan_ec_matrix_calibration_access_cb_t cb,
+                                               const void *user_data, k_timeout_t timeout) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    int ret = k_mutex_lock(&data->mutex, timeout);
+
+    if (ret < 0) {
+        return -EAGAIN;
+    }
+
+    // Only the keys whose entries the callback replaced, e.g. when loading from settings, get
+    // their limits re-derived.
+    if (cb(dev, data->calibrations, cfg->inputs_len * cfg->strobes_len, user_data)) {
+        kscan_ec_matrix_update_thresholds(dev);
+    }
+
+    k_mutex_unlock(&data->mutex);
+
+    return 0;
+}
+
+int zmk_kscan_ec_matrix_access_calibration(const struct device *dev,
+                                           zmk_kscan_ec_matrix_calibration_access_cb_t cb,
+                                           const void *user_data) {
+    return zmk_kscan_ec_matrix_try_access_calibration(dev, cb, user_data, K_SECONDS(1));
+}
+
+int zmk_kscan_ec_matrix_copy_calibration(const struct device *dev,
+                                         struct zmk_kscan_ec_matrix_calibration_entry *entries,
+                                         size_t len) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    if (len != cfg->inputs_len * cfg->strobes_len) {
+        return -EINVAL;
+    }
+
+    int ret = k_mutex_lock(&data->mutex, K_SECONDS(1));
+
+    if (ret < 0) {
+        return -EAGAIN;
+    }
+
+    memcpy(entries, data->calibrations, len * sizeof(data->calibrations[0]));
+
+    k_mutex_unlock(&data->mutex);
+
+    return 0;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+
+#define TRACE_RING_MASK (CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE_RING_SIZE - 1)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE_RING_SIZE),
+             "CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE_RING_SIZE must be a power of two");
+
+// Single producer side of the trace ring, only ever called from the scan thread. Records are
+// dropped rather than overwritten when the consumer falls behind.
+static inline void trace_sample(struct kscan_ec_matrix_data *data,
+                                const struct zmk_kscan_ec_matrix_trace_record *record) {
+    uint32_t head = atomic_get(&data->trace_head);
+
+    if (head - (uint32_t)atomic_get(&data->trace_tail) > TRACE_RING_MASK) {
+        atomic_inc(&data->trace_dropped);
+        return;
+    }
+
+    data->trace_records[head & TRACE_RING_MASK] = *record;
+    atomic_set(&data->trace_head, head + 1);
+}
+
+size_t zmk_kscan_ec_matrix_trace_drain(const struct device *dev,
+                                       struct zmk_kscan_ec_matrix_trace_record *records,
+                                       size_t max) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    uint32_t tail = atomic_get(&data->trace_tail);
+    uint32_t available = (uint32_t)atomic_get(&data->trace_head) - tail;
+    size_t count = MIN(available, max);
+
+    for (size_t i = 0; i < count; i++) {
+        records[i] = data->trace_records[(tail + i) & TRACE_RING_MASK];
+    }
+
+    atomic_set(&data->trace_tail, tail + count);
+
+    return count;
+}
+
+uint32_t zmk_kscan_ec_matrix_trace_dropped(const struct device *dev) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    return atomic_set(&data->trace_dropped, 0);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+
+// Follows slow drift of the rest level with a first order IIR filter on samples from keys at
+// rest, re-deriving the key's limits only when the whole ADC count changes.
+static void baseline_track(const struct device *dev, uint8_t s, uint8_t r, uint16_t buf) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    int32_t *baseline = &data->baselines[(s * cfg->inputs_len) + r];
+    struct kscan_ec_matrix_threshold *threshold = &data->thresholds[(s * cfg->inputs_len) + r];
+
+    *baseline += (((int32_t)buf << BASELINE_FRACTION_BITS) - *baseline) >>
+                 CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING_SHIFT;
+
+    uint16_t avg_low = *baseline >> BASELINE_FRACTION_BITS;
+    if (avg_low == threshold->travel_low) {
+        return;
+    }
+
+    const struct zmk_kscan_ec_matrix_calibration_entry *calibration =
+        calibration_entry_for_strobe_input(dev, s, r);
+    int32_t max_drift = ((calibration->avg_high - calibration->avg_low) *
+                         CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_MAX_DRIFT_PERCENTAGE) /
+                        100;
+
+    avg_low = CLAMP(avg_low, MAX((int32_t)calibration->avg_low - max_drift, 0),
+                    calibration->avg_low + max_drift);
+    if (avg_low == threshold->travel_low) {
+        return;
+    }
+
+    compute_threshold(cfg, calibration, avg_low, threshold);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+
+// The first press of a stroke still needs the static press limit. After that, a key releases as
+// soon as it rises the release delta above the deepest point reached, and presses again once it
+// sinks the press delta below the shallowest point, until it returns past the release limit.
+static inline bool rapid_trigger_evaluate(const struct kscan_ec_matrix_threshold *threshold,
+                                          uint16_t *extremum, uint16_t buf, bool prev) {
+    if (prev) {
+        *extremum = MAX(*extremum, buf);
+
+        if (buf < threshold->release) {
+            *extremum = 0;
+            return false;
+        }
+
+        if (buf + threshold->rapid_release_delta < *extremum) {
+            *extremum = buf;
+            return false;
+        }
+
+        return true;
+    }
+
+    if (*extremum == 0) {
+        if (buf > threshold->press) {
+            *extremum = buf;
+            return true;
+        }
+
+        return false;
+    }
+
+    if (buf < threshold->release) {
+        *extremum = 0;
+        return false;
+    }
+
+    *extremum = MIN(*extremum, buf);
+
+    if (buf > *extremum + threshold->rapid_press_delta) {
+        *extremum = buf;
+        return true;
+    }
+
+    return false;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+
+static inline void kscan_ec_matrix_evaluate(const struct device *dev, uint8_t s, uint8_t r,
+                                            uint16_t buf, uint64_t *rows) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    const struct kscan_ec_matrix_threshold *threshold =
+        &data->thresholds[(s * cfg->inputs_len) + r];
+    bool prev = ec_matrix_bitset_test(strobe_row(cfg, data->matrix_state, s), r);
+    bool pressed = prev ? buf >= threshold->release : buf > threshold->press;
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+    if (cfg->rapid_trigger) {
+        uint16_t *extremum = &data->rapid_extremums[(s * cfg->inputs_len) + r];
+        uint16_t before = *extremum;
+
+        pressed = rapid_trigger_evaluate(threshold, extremum, buf, prev);
+        if (pressed != prev) {
+            data->rapid_extremums_before[(s * cfg->inputs_len) + r] = before;
+        }
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+
+    ec_matrix_bitset_assign(strobe_row(cfg, rows, s), r, pressed);
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+    if (!prev && !pressed && buf <= threshold->rest_limit) {
+        baseline_track(dev, s, r, buf);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+    data->analog_back[(s * cfg->inputs_len) + r] = threshold_travel(threshold, buf);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+    trace_sample(data, &(struct zmk_kscan_ec_matrix_trace_record){
+                           .timestamp = k_cycle_get_32(),
+                           .raw = buf,
+                           .normalized = threshold_travel(threshold, buf),
+                           .strobe = s,
+                           .input = r,
+                           .decision = (pressed ? ZMK_KSCAN_EC_MATRIX_TRACE_DOWN
+                                                : ZMK_KSCAN_EC_MATRIX_TRACE_UP) |
+                                       (pressed != prev ? ZMK_KSCAN_EC_MATRIX_TRACE_CHANGED : 0),
+                       });
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+
+// Readers hold a frame without locking; the writer only reuses a buffer two frames later, which
+// readers detect by comparing the frame sequence with the one being written.
+static void analog_frame_begin(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    uint32_t sequence = (uint32_t)atomic_get(&data->analog_published) + 1;
+
+    atomic_set(&data->analog_writing, sequence);
+    data->analog_back =
+        &data->analog_frames[(sequence & 1) * cfg->strobes_len * cfg->inputs_len];
+
+    // The scan never writes inactive keys, so their last travel would otherwise linger in the
+    // buffer.
+    if (data->analog_clear_frames > 0) {
+        data->analog_clear_frames--;
+
+        for (int s = 0; s < cfg->strobes_len; s++) {
+            for (int i = 0; i < cfg->inputs_len; i++) {
+                if (!ec_matrix_bitset_test(strobe_row(cfg, data->active_inputs, s), i)) {
+                    data->analog_back[(s * cfg->inputs_len) + i] = 0;
+                }
+            }
+        }
+    }
+}
+
+static void analog_frame_publish(const struct device *dev) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    atomic_set(&data->analog_published, atomic_get(&data->analog_writing));
 }
 
-#define SAMPLE_COUNT 20
+// Publishes a copy of the current frame with inactive keys cleared, and has the next frame clear
+// them in the other buffer too. Readers may still hold the published frame, so it is never
+// cleared in place. Must not run while a scan is writing a frame.
+static void analog_frame_clear_inactive(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
 
-struct sample_results {
-    uint16_t min;
-    uint16_t max;
-    uint16_t avg;
-    uint16_t noise;
-};
+    uint32_t sequence = atomic_get(&data->analog_published);
+    if (sequence == 0) {
+        // Both buffers are still clear and the first scan writes every active key.
+        return;
+    }
 
-struct sample_results sample(const struct device *dev, int s, int i) {
-    uint16_t min = 0, max = 0, avg = 0;
+    const uint16_t *published =
+        &data->analog_frames[(sequence & 1) * cfg->strobes_len * cfg->inputs_len];
 
-    for (int sample = 0; sample < SAMPLE_COUNT; sample++) {
-        uint16_t val = read_raw_matrix_state(dev, s, i);
+    data->analog_clear_frames = 2;
+    analog_frame_begin(dev);
 
-        if (sample == 0) {
-            avg = min = max = val;
-        } else {
-            max = MAX(val, max);
-            min = MIN(val, min);
-            avg = ((avg * sample) + val) / (sample + 1);
+    for (int s = 0; s < cfg->strobes_len; s++) {
+        for (int i = 0; i < cfg->inputs_len; i++) {
+            if (ec_matrix_bitset_test(strobe_row(cfg, data->active_inputs, s), i)) {
+                data->analog_back[(s * cfg->inputs_len) + i] =
+                    published[(s * cfg->inputs_len) + i];
+            }
         }
+    }
+
+    analog_frame_publish(dev);
+}
+
+int zmk_kscan_ec_matrix_analog_frame_get(const struct device *dev,
+                                         struct zmk_kscan_ec_matrix_analog_frame *frame) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
 
-        k_sleep(K_MSEC(1));
+    uint32_t sequence = atomic_get(&data->analog_published);
+    if (sequence == 0) {
+        return -EAGAIN;
     }
 
-    return (struct sample_results){
-        .min = min,
-        .max = max,
-        .avg = avg,
-        .noise = max - min,
+    *frame = (struct zmk_kscan_ec_matrix_analog_frame){
+        .travel = &data->analog_frames[(sequence & 1) * cfg->strobes_len * cfg->inputs_len],
+        .sequence = sequence,
+        .strobes_len = cfg->strobes_len,
+        .inputs_len = cfg->inputs_len,
     };
-}
 
-uint16_t normalize(uint16_t val, uint16_t avg_low, uint16_t avg_high) {
-    val = MAX(val, avg_low);
-    val = MIN(val, avg_high);
+    return 0;
+}
 
-    uint32_t numerator = UINT16_MAX * (val - avg_low);
-    uint16_t denominator = avg_high - avg_low;
+bool zmk_kscan_ec_matrix_analog_frame_valid(const struct device *dev,
+                                            const struct zmk_kscan_ec_matrix_analog_frame *frame) {
+    struct kscan_ec_matrix_data *data = dev->data;
 
-    return (uint16_t)(numerator / denominator);
+    return (uint32_t)atomic_get(&data->analog_writing) - frame->sequence <= 1;
 }
 
-#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
 
-void calibrate(const struct device *dev) {
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_ASYNC)
+
+// Advances to the next active key in scan order (inputs outer, strobes inner). strobe_at and
+// input_at are positions in strobe_order and input_order. Returns false once every key has been
+// visited.
+static bool next_active_key(const struct device *dev, uint8_t *strobe_at, uint8_t *input_at,
+                            bool first) {
     const struct kscan_ec_matrix_config *cfg = dev->config;
     struct kscan_ec_matrix_data *data = dev->data;
-    uint16_t keys_to_complete = 0;
-    if (data->calibration_callback) {
-        struct zmk_kscan_ec_matrix_calibration_event ev = {
-            .type = CALIBRATION_EV_LOW_SAMPLING_START, .data = {}};
-        data->calibration_callback(&ev, data->calibration_user_data);
-    }
-
-    if (cfg->power.port) {
-        gpio_pin_set_dt(&cfg->power, 1);
-        k_busy_wait(cfg->matrix_warm_up_us);
-    }
 
-    // Read one sample and toss it. This ensures the ADC has been enabled before taking real
-    // samples.
-    read_raw_matrix_state(dev, 0, 0);
+    int os = first ? 0 : *strobe_at + 1;
 
-    for (int s = 0; s < cfg->strobes_len; s++) {
-        for (int i = 0; i < cfg->inputs_len; i++) {
-            if (cfg->strobe_input_masks && (cfg->strobe_input_masks[s] & BIT(i)) != 0) {
-                continue;
-            }
+    for (int oi = first ? 0 : *input_at; oi < data->input_order_len; oi++, os = 0) {
+        uint8_t r = data->input_order[oi];
 
-            struct zmk_kscan_ec_matrix_calibration_entry *calibration =
-                calibration_entry_for_strobe_input(dev, s, i);
-            memset(calibration, 0, sizeof(struct zmk_kscan_ec_matrix_calibration_entry));
-            struct sample_results low_res = sample(dev, s, i);
-
-            LOG_DBG("Low avg for %d,%d using %d and %d is %d. Noise %d", s, i, low_res.max,
-                    low_res.min, low_res.avg, low_res.noise);
-            if (data->calibration_callback) {
-                struct zmk_kscan_ec_matrix_calibration_event ev = {
-                    .type = CALIBRATION_EV_POSITION_LOW_DETERMINED,
-                    .data = {.position_low_determined = {.low_avg = low_res.avg,
-                                                         .strobe = s,
-                                                         .input = i,
-                                                         .noise = low_res.noise}}};
-                data->calibration_callback(&ev, data->calibration_user_data);
+        for (; os < data->strobe_order_len; os++) {
+            if (ec_matrix_bitset_test(strobe_row(cfg, data->active_inputs, data->strobe_order[os]),
+                                      r)) {
+                *strobe_at = os;
+                *input_at = oi;
+                return true;
             }
-
-            calibration->avg_low = low_res.avg;
-            calibration->noise = low_res.noise;
-            keys_to_complete++;
         }
     }
 
-    if (data->calibration_callback) {
-        struct zmk_kscan_ec_matrix_calibration_event ev = {
-            .type = CALIBRATION_EV_HIGH_SAMPLING_START, .data = {}};
-        data->calibration_callback(&ev, data->calibration_user_data);
-    }
+    return false;
+}
 
-    while (keys_to_complete > 0) {
-        for (int s = 0; s < cfg->strobes_len; s++) {
-            for (int i = 0; i < cfg->inputs_len; i++) {
-                if (cfg->strobe_input_masks && (cfg->strobe_input_masks[s] & BIT(i)) != 0) {
-                    continue;
-                }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_ASYNC)
 
-                struct zmk_kscan_ec_matrix_calibration_entry *calibration =
-                    calibration_entry_for_strobe_input(dev, s, i);
+// Undoes the state kscan_ec_matrix_evaluate() committed for a flip that a confirmation read
+// rejected, buf being the rejecting sample and pressed the state the key stays in.
+static void kscan_ec_matrix_reject_change(const struct device *dev, uint8_t s, uint8_t r,
+                                          uint16_t buf, bool pressed) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
 
-                if (calibration->avg_high > 0) {
-                    continue;
-                }
+    const struct kscan_ec_matrix_threshold *threshold =
+        &data->thresholds[(s * cfg->inputs_len) + r];
 
-                // Set the high threshold to half the full range possible
-                uint16_t high_threshold = (1 << (cfg->adc_channel.resolution - 1));
-                uint16_t high_check_val = read_raw_matrix_state(dev, s, i);
+    // Only used by the optional state below.
+    ARG_UNUSED(threshold);
+    ARG_UNUSED(buf);
+    ARG_UNUSED(pressed);
 
-                if (high_check_val < high_threshold) {
-                    continue;
-                }
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+    if (cfg->rapid_trigger) {
+        data->rapid_extremums[(s * cfg->inputs_len) + r] =
+            data->rapid_extremums_before[(s * cfg->inputs_len) + r];
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+    data->analog_back[(s * cfg->inputs_len) + r] = threshold_travel(threshold, buf);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+    trace_sample(data, &(struct zmk_kscan_ec_matrix_trace_record){
+                           .timestamp = k_cycle_get_32(),
+                           .raw = buf,
+                           .normalized = threshold_travel(threshold, buf),
+                           .strobe = s,
+                           .input = r,
+                           .decision = (pressed ? ZMK_KSCAN_EC_MATRIX_TRACE_DOWN
+                                                : ZMK_KSCAN_EC_MATRIX_TRACE_UP) |
+                                       ZMK_KSCAN_EC_MATRIX_TRACE_REJECTED,
+                       });
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+}
 
-                k_sleep(K_MSEC(1));
+// Re-samples every key whose state flipped during this pass, keeping the flip only if all of the
+// confirmation reads agree with it.
+static void kscan_ec_matrix_confirm_changes(const struct device *dev, uint64_t *rows) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
 
-                // Double checks to filter funky random one-off spikes
-                high_check_val = read_raw_matrix_state(dev, s, i);
+    for (int k = 0; k < cfg->strobes_len * cfg->row_words; k++) {
+        uint8_t s = k / cfg->row_words;
+
+        for (uint64_t changed = rows[k] ^ data->matrix_state[k]; changed != 0;
+             changed &= changed - 1) {
+            int bit = u64_count_trailing_zeros(changed);
+            int r = ((k % cfg->row_words) * EC_MATRIX_BITSET_WORD_BITS) + bit;
+            const struct kscan_ec_matrix_threshold *threshold =
+                &data->thresholds[(s * cfg->inputs_len) + r];
+            bool pressed = (rows[k] & BIT64(bit)) != 0;
+            uint16_t press_limit = threshold->press;
+            uint16_t release_limit = threshold->release;
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
+            // A rapid trigger change is confirmed as long as the key does not move back by the
+            // opposite delta from the point where it changed.
+            uint16_t extremum = data->rapid_extremums[(s * cfg->inputs_len) + r];
+            if (cfg->rapid_trigger && extremum != 0) {
+                press_limit = MIN(press_limit, MAX(extremum, threshold->rapid_release_delta) -
+                                                   threshold->rapid_release_delta);
+                release_limit = MAX(release_limit, extremum + threshold->rapid_press_delta);
+            }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER)
 
-                if (high_check_val < high_threshold) {
-                    continue;
-                }
+            for (int i = 0; i < cfg->confirm_reads; i++) {
+                uint16_t buf = read_raw_matrix_state(dev, s, r);
 
-                LOG_WRN("Getting high for %d/%d after %d is higher than threashold: %d for "
-                        "resolution %d",
-                        s, i, high_check_val, high_threshold, cfg->adc_channel.resolution);
-                k_sleep(K_MSEC(200));
-
-                struct sample_results high_res = sample(dev, s, i);
-
-                // Rough approximation of SNR by using avg difference + noise over noise
-                uint16_t snr =
-                    (high_res.avg - calibration->avg_low + calibration->noise) / calibration->noise;
-                LOG_DBG("High avg for %d,%d is %d. SNR %d", s, i, high_res.avg, snr);
-
-                calibration->avg_high = high_res.avg;
-                calibration->noise = MAX(calibration->noise, high_res.noise);
-                keys_to_complete--;
-
-                if (data->calibration_callback) {
-                    struct zmk_kscan_ec_matrix_calibration_event ev = {
-                        .type = CALIBRATION_EV_POSITION_COMPLETE,
-                        .data = {.position_complete = {.high_avg = calibration->avg_high,
-                                                       .snr = snr,
-                                                       .low_avg = calibration->avg_low,
-                                                       .strobe = s,
-                                                       .input = i,
-                                                       .noise = calibration->noise}}};
-                    data->calibration_callback(&ev, data->calibration_user_data);
+                if (pressed ? buf <= press_limit : buf >= release_limit) {
+                    rows[k] ^= BIT64(bit);
+                    kscan_ec_matrix_reject_change(dev, s, r, buf, !pressed);
+                    break;
                 }
-
-                k_sleep(K_MSEC(1));
             }
-
-            k_sleep(K_MSEC(1));
         }
-
-        k_sleep(K_MSEC(1));
     }
+}
 
-    if (cfg->power.port) {
-        gpio_pin_set_dt(&cfg->power, 0);
-    }
+#define DEBOUNCE_PENDING BIT(31)
+#define DEBOUNCE_TIMESTAMP_MASK BIT_MASK(31)
 
-    if (data->calibration_callback) {
-        struct zmk_kscan_ec_matrix_calibration_event ev = {
-            .type = CALIBRATION_EV_COMPLETE,
-        };
-        data->calibration_callback(&ev, data->calibration_user_data);
-    }
+// Advances the debounce state machine of one key by a sample. For the timed policies the state
+// holds a pending flag and the cycle count at which the sample started to disagree with the
+// debounced state; for N-of-M it holds the most recent samples, newest in bit 0.
+static bool kscan_ec_matrix_debounce_key(const struct device *dev, uint32_t *state, bool sample,
+                                         bool debounced, uint32_t now, bool *settled) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+    struct kscan_ec_matrix_data *data = dev->data;
 
-    data->calibration_callback = NULL;
-    data->calibration_user_data = NULL;
-}
+    switch (cfg->debounce_policy) {
+    case DEBOUNCE_POLICY_N_OF_M: {
+        uint32_t window_mask = BIT_MASK(cfg->debounce_window);
+        uint32_t history = ((*state << 1) | sample) & window_mask;
+        uint8_t votes = POPCOUNT(history);
 
-int zmk_kscan_ec_matrix_calibrate(const struct device *dev,
-                                  zmk_kscan_ec_matrix_calibration_cb_t callback,
-                                  const void *user_data) {
-    struct kscan_ec_matrix_data *data = dev->data;
+        *state = history;
 
-    int ret = k_mutex_lock(&data->mutex, K_SECONDS(1));
+        if (!debounced && votes >= cfg->debounce_votes) {
+            debounced = true;
+        } else if (debounced && cfg->debounce_window - votes >= cfg->debounce_votes) {
+            debounced = false;
+        }
 
-    if (ret < 0) {
-        return -EAGAIN;
+        *settled = history == (debounced ? window_mask : 0);
+        return debounced;
     }
+    case DEBOUNCE_POLICY_EAGER_PRESS:
+    case DEBOUNCE_POLICY_TIME: {
+        if (sample == debounced) {
+            *state = 0;
+            *settled = true;
+            return debounced;
+        }
 
-    data->calibration_callback = callback;
-    data->calibration_user_data = user_data;
+        uint32_t hold_cycles = sample ? data->debounce_press_cycles : data->debounce_release_cycles;
+        if (sample && cfg->debounce_policy == DEBOUNCE_POLICY_EAGER_PRESS) {
+            hold_cycles = 0;
+        }
 
-    k_mutex_unlock(&data->mutex);
+        if ((*state & DEBOUNCE_PENDING) == 0) {
+            *state = DEBOUNCE_PENDING | (now & DEBOUNCE_TIMESTAMP_MASK);
+        }
 
-    return 0;
-}
+        if (((now - *state) & DEBOUNCE_TIMESTAMP_MASK) >= hold_cycles) {
+            *state = 0;
+            *settled = true;
+            return sample;
+        }
 
-#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
+        *settled = false;
+        return debounced;
+    }
+    default:
+        *settled = true;
+        return sample;
+    }
+}
 
-int zmk_kscan_ec_matrix_access_calibration(const struct device *dev,
-                                           zmk_kscan_ec_matrix_calibration_access_cb_t cb,
-                                           const void *user_data) {
+// Filters one word of the samples from this scan, word k of the key bitsets, into the state to
+// report.
+static uint64_t kscan_ec_matrix_debounce(const struct device *dev, int k, uint64_t row) {
     const struct kscan_ec_matrix_config *cfg = dev->config;
     struct kscan_ec_matrix_data *data = dev->data;
 
-    int ret = k_mutex_lock(&data->mutex, K_SECONDS(1));
-
-    if (ret < 0) {
-        return -EAGAIN;
+    if (cfg->debounce_policy == DEBOUNCE_POLICY_TWO_SCAN) {
+        // Without confirmation reads, a state has to be seen by two consecutive scans.
+        return cfg->confirm_reads > 0 ? row : row & data->matrix_state[k];
     }
 
-    cb(dev, data->calibrations, cfg->inputs_len * cfg->strobes_len, user_data);
-
-    k_mutex_unlock(&data->mutex);
+    uint8_t s = k / cfg->row_words;
+    int first_input = (k % cfg->row_words) * EC_MATRIX_BITSET_WORD_BITS;
+    uint64_t debounced = data->reported_matrix_state[k];
+    uint64_t visit = (row ^ debounced) | data->debounce_unsettled[k];
+    uint32_t now = k_cycle_get_32();
+
+    for (; visit != 0; visit &= visit - 1) {
+        int bit = u64_count_trailing_zeros(visit);
+        bool settled;
+        bool pressed = kscan_ec_matrix_debounce_key(
+            dev, &data->debounce_states[(s * cfg->inputs_len) + first_input + bit],
+            (row & BIT64(bit)) != 0, (debounced & BIT64(bit)) != 0, now, &settled);
+
+        debounced = pressed ? (debounced | BIT64(bit)) : (debounced & ~BIT64(bit));
+        data->debounce_unsettled[k] = settled ? (data->debounce_unsettled[k] & ~BIT64(bit))
+                                              : (data->debounce_unsettled[k] | BIT64(bit));
+    }
 
-    return 0;
+    return debounced;
 }
 
 static void kscan_ec_matrix_read(const struct device *dev) {
     const struct kscan_ec_matrix_config *cfg = dev->config;
     struct kscan_ec_matrix_data *data = dev->data;
 
-    uint64_t rows[cfg->strobes_len];
+    uint64_t rows[cfg->strobes_len * cfg->row_words];
 
-    for (int s = 0; s < cfg->strobes_len; s++) {
-        rows[s] = 0;
-    }
+    memset(rows, 0, sizeof(rows));
 
     if (cfg->power.port) {
         gpio_pin_set_dt(&cfg->power, 1);
         k_busy_wait(cfg->matrix_warm_up_us);
     }
 
-    for (int r = 0; r < cfg->inputs_len; r++) {
-        for (int s = 0; s < cfg->strobes_len; s++) {
-            struct zmk_kscan_ec_matrix_calibration_entry *calibration =
-                calibration_entry_for_strobe_input(dev, s, r);
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+    analog_frame_begin(dev);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
 
-            if (!calibration || calibration->avg_high == 0) {
-                continue;
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_ASYNC)
+    // Pipeline the scan: key N+1 is started as soon as key N has been read, and key N is
+    // evaluated while key N+1 converts.
+    struct async_read read;
+    uint8_t os = 0, oi = 0;
+
+    k_poll_signal_init(&read.signal);
+
+    bool have_next = next_active_key(dev, &os, &oi, true);
+    if (have_next) {
+        arm_raw_matrix_read(dev, &read, data->strobe_order[os], data->input_order[oi]);
+        fire_raw_matrix_read(dev, &read);
+    }
+
+    while (have_next) {
+        uint8_t cur_s = data->strobe_order[os], cur_r = data->input_order[oi];
+        uint16_t buf = finish_raw_matrix_read(dev, &read);
+
+        have_next = next_active_key(dev, &os, &oi, false);
+        if (have_next) {
+            arm_raw_matrix_read(dev, &read, data->strobe_order[os], data->input_order[oi]);
+            fire_raw_matrix_read(dev, &read);
+        }
+
+        kscan_ec_matrix_evaluate(dev, cur_s, cur_r, buf, rows);
+    }
+#else
+    for (int oi = 0; oi < data->input_order_len; oi++) {
+        uint8_t r = data->input_order[oi];
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_BATCHED)
+        uint8_t strobes[cfg->strobes_len];
+        uint8_t strobes_len = 0;
+
+        for (int os = 0; os < data->strobe_order_len; os++) {
+            uint8_t s = data->strobe_order[os];
+
+            if (ec_matrix_bitset_test(strobe_row(cfg, data->active_inputs, s), r)) {
+                strobes[strobes_len++] = s;
             }
+        }
+
+        if (strobes_len == 0) {
+            continue;
+        }
+
+        int16_t bufs[strobes_len];
+        read_raw_input_strobes(dev, r, strobes, strobes_len, bufs);
 
-            if (cfg->strobe_input_masks && (cfg->strobe_input_masks[s] & BIT(r)) != 0) {
+        for (int i = 0; i < strobes_len; i++) {
+            kscan_ec_matrix_evaluate(dev, strobes[i], r, bufs[i], rows);
+        }
+#else
+        for (int os = 0; os < data->strobe_order_len; os++) {
+            uint8_t s = data->strobe_order[os];
+
+            if (!ec_matrix_bitset_test(strobe_row(cfg, data->active_inputs, s), r)) {
                 continue;
             }
 
-            bool prev = (data->matrix_state[s] & BIT(r)) != 0;
-            uint16_t buf = read_raw_matrix_state(dev, s, r);
-            printk("reading_raw: %d, %d, %d\n", s, r, buf);   // debug
-
-            buf = normalize(buf, calibration->avg_low, calibration->avg_high);
-            printk("reading_normalized: %d, %d, %d\n", s, r, buf);   // debug
-
-            uint32_t range = calibration->avg_high - calibration->avg_low;
-            uint16_t press_limit_raw =
-                calibration->avg_high -
-                (uint16_t)(MAX((range * cfg->trigger_percentage) / 100, calibration->noise));
-            printk("press_limit_raw: %d, %d, %d\n", s, r, press_limit_raw);   // debug
-            uint16_t hys_buffer = MAX(range / 8, calibration->noise);
-            uint16_t press_limit =
-                normalize(press_limit_raw, calibration->avg_low, calibration->avg_high);
-                printk("press_limit: %d, %d, %d\n", s, r, press_limit);   // debug
-            uint16_t release_limit = normalize(press_limit_raw - hys_buffer, calibration->avg_low,
-                                               calibration->avg_high);
-
-            if (buf > press_limit && !prev) {
-                WRITE_BIT(rows[s], r, 1);
-            } else if (prev && buf < release_limit) {
-                WRITE_BIT(rows[s], r, 0);
-            } else {
-                WRITE_BIT(rows[s], r, prev);
-            }
+            kscan_ec_matrix_evaluate(dev, s, r, read_raw_matrix_state(dev, s, r), rows);
 
             k_yield();
         }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_BATCHED)
 
         k_yield();
     }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_ASYNC)
+
+    if (cfg->confirm_reads > 0) {
+        kscan_ec_matrix_confirm_changes(dev, rows);
+    }
 
     if (cfg->power.port) {
         gpio_pin_set_dt(&cfg->power, 0);
     }
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+    analog_frame_publish(dev);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
     bool have_change = false;
     bool have_keys = false;
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
 
-    uint64_t diffs[cfg->strobes_len];
-    for (int s = 0; s < cfg->strobes_len; s++) {
-        diffs[s] = rows[s] & data->matrix_state[s];
-        if (rows[s] && rows[s] != data->matrix_state[s]) {
-            LOG_DBG("Initial press detected for %d/%lld", s, rows[s] ^ data->matrix_state[s]);
+    // Walks the key bitsets a word at a time, word k holding inputs from first_input onwards of
+    // strobe s.
+    for (int k = 0; k < cfg->strobes_len * cfg->row_words; k++) {
+        uint8_t s = k / cfg->row_words;
+        int first_input = (k % cfg->row_words) * EC_MATRIX_BITSET_WORD_BITS;
+        uint64_t diff = kscan_ec_matrix_debounce(dev, k, rows[k]);
+        if (rows[k] && rows[k] != data->matrix_state[k]) {
+            LOG_DBG("Initial press detected for %d/%lld", s, rows[k] ^ data->matrix_state[k]);
         }
-        data->matrix_state[s] = rows[s];
-    }
+        data->matrix_state[k] = rows[k];
 
-    for (int s = 0; s < cfg->strobes_len; s++) {
-        uint64_t diff = diffs[s];
-        for (int r = 0; r < cfg->inputs_len; r++) {
-            if ((data->reported_matrix_state[s] & BIT(r)) != (diff & BIT(r))) {
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
-                have_change = true;
+        have_keys = have_keys || diff != 0;
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
 
-                LOG_DBG("Reporting %d/%d as %s", s, r, (diff & BIT(r)) ? "on" : "off");
-                if (data->callback) {
-                    data->callback(data->dev, s, r, diff & BIT(r));
-                }
-            } else if ((rows[s] & BIT(r)) &&
-                       (data->reported_matrix_state[s] & BIT(r)) != (rows[s] & BIT(r))) {
-                LOG_DBG("Bit enabled but not reporting yet %d/%d", s, r);
-            }
+        // Nearly every scan changes nothing, so only visit the bits that differ from what was
+        // last reported.
+        uint64_t changed = data->reported_matrix_state[k] ^ diff;
+        if (changed == 0) {
+            continue;
         }
 
-        data->reported_matrix_state[s] = diff;
-
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
-        have_keys = have_keys || diff != 0;
+        have_change = true;
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
+
+        data->reported_matrix_state[k] = diff;
+
+        for (; changed != 0; changed &= changed - 1) {
+            int bit = u64_count_trailing_zeros(changed);
+            int r = first_input + bit;
+            bool pressed = (diff & BIT64(bit)) != 0;
+
+            LOG_DBG("Reporting %d/%d as %s", s, r, pressed ? "on" : "off");
+            if (data->callback) {
+                data->callback(data->dev, s, r, pressed);
+            }
+        }
     }
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
@@ -586,26 +1978,28 @@ static void kscan_ec_matrix_update_poll_interval(const struct device *dev) {
     const struct kscan_ec_matrix_config *cfg = dev->config;
 
     uint32_t last_released_at = data->last_key_released_at;
-    uint32_t prev_poll_interval = data->poll_interval;
-    uint32_t new_poll_interval = 0;
+    uint32_t prev_poll_interval_us = data->poll_interval_us;
+    uint32_t new_poll_interval_us = 0;
 
     if (last_released_at == 0) {
-        new_poll_interval = cfg->active_polling_interval_ms;
+        new_poll_interval_us = cfg->active_polling_interval_us;
     } else {
         uint32_t ms_since_last_released = k_uptime_get() - last_released_at;
 
         if (ms_since_last_released > cfg->sleep_after_secs * 1000) {
-            new_poll_interval = cfg->sleep_polling_interval_ms;
+            new_poll_interval_us = cfg->sleep_polling_interval_ms * USEC_PER_MSEC;
         } else if (ms_since_last_released > cfg->idle_after_secs * 1000) {
-            new_poll_interval = cfg->idle_polling_interval_ms;
+            new_poll_interval_us = cfg->idle_polling_interval_ms * USEC_PER_MSEC;
         } else {
-            new_poll_interval = cfg->active_polling_interval_ms;
+            new_poll_interval_us = cfg->active_polling_interval_us;
         }
     }
 
-    if (new_poll_interval != prev_poll_interval) {
-        LOG_WRN("Poll interval: %d -> %d", prev_poll_interval, new_poll_interval);
-        data->poll_interval = new_poll_interval;
+    if (new_poll_interval_us != prev_poll_interval_us) {
+        LOG_WRN("Poll interval: %dus -> %dus", prev_poll_interval_us, new_poll_interval_us);
+        data->poll_interval_us = new_poll_interval_us;
+        k_timer_start(&data->scan_timer, K_USEC(new_poll_interval_us),
+                      K_USEC(new_poll_interval_us));
     }
 }
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
@@ -626,6 +2020,12 @@ uint64_t zmk_kscan_ec_matrix_max_scan_duration_ns(const struct device *dev) {
 
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
 
+uint32_t zmk_kscan_ec_matrix_scan_overruns(const struct device *dev) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    return data->scan_overruns;
+}
+
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
 
 struct zmk_kscan_ec_matrix_read_timing zmk_kscan_ec_matrix_read_timing(const struct device *dev) {
@@ -634,6 +2034,8 @@ struct zmk_kscan_ec_matrix_read_timing zmk_kscan_ec_matrix_read_timing(const str
     k_mutex_lock(&data->mutex, K_MSEC(10));
 
     struct zmk_kscan_ec_matrix_read_timing val = data->read_timing;
+    val.irq_locked_max_ns = data->irq_locked_max_ns;
+    val.relax_saved_ns = data->relax_saved_ns;
 
     k_mutex_unlock(&data->mutex);
 
@@ -642,6 +2044,84 @@ struct zmk_kscan_ec_matrix_read_timing zmk_kscan_ec_matrix_read_timing(const str
 
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+
+static inline uint32_t boot_uptime_us(void) {
+    return (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+struct zmk_kscan_ec_matrix_boot_timing zmk_kscan_ec_matrix_boot_timing(const struct device *dev) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    k_mutex_lock(&data->mutex, K_MSEC(10));
+
+    struct zmk_kscan_ec_matrix_boot_timing val = data->boot_timing;
+
+    k_mutex_unlock(&data->mutex);
+
+    return val;
+}
+
+void zmk_kscan_ec_matrix_boot_timing_calibration_loaded(const struct device *dev) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    if (data->boot_timing.calibration_loaded_us == 0) {
+        data->boot_timing.calibration_loaded_us = boot_uptime_us();
+        LOG_INF("Stored calibration in use %uus after boot",
+                data->boot_timing.calibration_loaded_us);
+    }
+}
+
+void zmk_kscan_ec_matrix_boot_timing_calibration_absent(const struct device *dev) {
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    if (data->boot_timing.calibration_absent_us == 0) {
+        data->boot_timing.calibration_absent_us = boot_uptime_us();
+        LOG_INF("No stored calibration found %uus after boot",
+                data->boot_timing.calibration_absent_us);
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+
+static int kscan_ec_matrix_startup_calibration(const struct device *dev) {
+    const struct kscan_ec_matrix_config *cfg = dev->config;
+
+    if (cfg->skip_startup_calibration) {
+        return 0;
+    }
+
+    int16_t buf = 0;
+    struct adc_sequence sequence = {
+        .buffer = &buf,
+        .buffer_size = sizeof(buf),
+    };
+
+    adc_sequence_init_dt(&cfg->adc_channel, &sequence);
+    sequence.calibrate = true;
+
+    int err = adc_read(cfg->adc_channel.dev, &sequence);
+    if (err < 0) {
+        LOG_ERR("Failed to calibrate on startup: %d", err);
+        return err;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+    struct kscan_ec_matrix_data *data = dev->data;
+
+    data->boot_timing.adc_calibrated_us = boot_uptime_us();
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+
+    return 0;
+}
+
+static void kscan_ec_matrix_scan_timer_expiry(struct k_timer *timer) {
+    struct kscan_ec_matrix_data *data =
+        CONTAINER_OF(timer, struct kscan_ec_matrix_data, scan_timer);
+
+    k_sem_give(&data->scan_sem);
+}
+
 static void kscan_ec_matrix_thread_main(void *arg1, void *unused1, void *unused2) {
     ARG_UNUSED(unused1);
     ARG_UNUSED(unused2);
@@ -649,45 +2129,148 @@ static void kscan_ec_matrix_thread_main(void *arg1, void *unused1, void *unused2
     const struct device *dev = (const struct device *)arg1;
     struct kscan_ec_matrix_data *data = dev->data;
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_FAST_BOOT)
+    // Moved off device init so the rest of boot does not wait on it. Scans only start after it.
+    kscan_ec_matrix_startup_calibration(dev);
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_FAST_BOOT)
+
     while (1) {
+        // Scans start on scan timer ticks so the period does not depend on the scan duration.
+        k_sem_take(&data->scan_sem, K_FOREVER);
         k_mutex_lock(&data->mutex, K_FOREVER);
 
+        // Discard expiries accumulated while the device was disabled.
+        k_timer_status_get(&data->scan_timer);
+
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
-        if (data->calibration_callback) {
-            calibrate(dev);
-#else
-        if (false) {
+        if (data->calibration_callback && data->calibration.phase == CALIBRATION_PHASE_IDLE) {
+            calibration_begin(dev);
+        }
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
 
-        } else {
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
-            timing_start();
-            timing_t c1 = timing_counter_get();
+        timing_start();
+        timing_t c1 = timing_counter_get();
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
 
-            kscan_ec_matrix_read(dev);
+        kscan_ec_matrix_read(dev);
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+        if (data->boot_timing.first_scan_us == 0) {
+            data->boot_timing.first_scan_us = boot_uptime_us();
+            LOG_INF("First scan done %uus after boot", data->boot_timing.first_scan_us);
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
-            const struct kscan_ec_matrix_config *cfg = dev->config;
-            if (cfg->dynamic_polling_interval) {
-                kscan_ec_matrix_update_poll_interval(dev);
-            }
+        const struct kscan_ec_matrix_config *cfg = dev->config;
+        if (cfg->dynamic_polling_interval) {
+            kscan_ec_matrix_update_poll_interval(dev);
+        }
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE)
 
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
-            timing_t c2 = timing_counter_get();
-            uint64_t cycles = timing_cycles_get(&c1, &c2);
-            uint64_t ns_spent = timing_cycles_to_ns(cycles);
-            timing_stop();
+        timing_t c2 = timing_counter_get();
+        uint64_t cycles = timing_cycles_get(&c1, &c2);
+        uint64_t ns_spent = timing_cycles_to_ns(cycles);
+        timing_stop();
 
-            data->max_scan_duration_ns = ns_spent;
+        data->max_scan_duration_ns = ns_spent;
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
+        if (data->calibration.phase != CALIBRATION_PHASE_IDLE) {
+            calibration_step(dev);
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+        data->irq_locked_max_ns = k_cyc_to_ns_ceil64(data->irq_locked_scan_cycles);
+        data->irq_locked_scan_cycles = 0;
+        data->relax_saved_ns = data->relax_scan_saved_ns;
+        data->relax_scan_saved_ns = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+
+        // The timer expired while scanning, so the scan overran its period. Drop the pending
+        // tick so the next scan starts back in phase instead of immediately.
+        if (k_timer_status_get(&data->scan_timer) > 0) {
+            data->scan_overruns++;
+            k_sem_reset(&data->scan_sem);
         }
         k_mutex_unlock(&data->mutex);
-        k_sleep(K_MSEC(data->poll_interval));
     }
 }
 
+// Position of a channel in the reflected Gray code sequence. Visiting the channels of a mux in
+// this order flips a single select line between consecutive channels.
+static inline uint8_t gray_code_rank(gpio_pin_t pin) {
+    uint8_t rank = pin;
+
+    for (uint8_t shift = 1; shift < 8; shift <<= 1) {
+        rank ^= rank >> shift;
+    }
+
+    return rank;
+}
+
+static bool input_unmasked(const struct kscan_ec_matrix_config *cfg, uint8_t i) {
+    for (int s = 0; s < cfg->strobes_len; s++) {
+        if (!input_masked(cfg, s, i)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool strobe_unmasked(const struct kscan_ec_matrix_config *cfg, uint8_t s) {
+    for (int i = 0; i < cfg->inputs_len; i++) {
+        if (!input_masked(cfg, s, i)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Plans the order in which scans visit a set of lines, leaving out the ones without unmasked
+// keys. Lines on the same port, e.g. the channels of one mux, are visited together in Gray code
+// order, so each step between them changes one select line and needs less settling. Lines that
+// are plain GPIOs are unaffected by the order.
+static uint8_t kscan_ec_matrix_plan_order(const struct kscan_ec_matrix_config *cfg,
+                                          const struct gpio_dt_spec *lines, uint8_t len,
+                                          bool (*unmasked)(const struct kscan_ec_matrix_config *,
+                                                           uint8_t),
+                                          uint8_t *order) {
+    uint16_t keys[len];
+    uint8_t order_len = 0;
+
+    for (uint8_t i = 0; i < len; i++) {
+        if (!unmasked(cfg, i)) {
+            continue;
+        }
+
+        // Ports are visited in the order of their first line.
+        uint8_t port_rank = 0;
+        while (lines[port_rank].port != lines[i].port) {
+            port_rank++;
+        }
+
+        uint16_t key = (port_rank << 8) | gray_code_rank(lines[i].pin);
+        uint8_t at = order_len++;
+
+        for (; at > 0 && keys[at - 1] > key; at--) {
+            keys[at] = keys[at - 1];
+            order[at] = order[at - 1];
+        }
+
+        keys[at] = key;
+        order[at] = i;
+    }
+
+    return order_len;
+}
+
 static int kscan_ec_matrix_init(const struct device *dev) {
     int err;
     struct kscan_ec_matrix_data *data = dev->data;
@@ -716,19 +2299,9 @@ static int kscan_ec_matrix_init(const struct device *dev) {
         return err;
     }
 
-    if (!cfg->skip_startup_calibration) {
-        int16_t buf = 0;
-        struct adc_sequence sequence = {
-            .buffer = &buf,
-            .buffer_size = sizeof(buf),
-        };
-
-        adc_sequence_init_dt(&cfg->adc_channel, &sequence);
-        sequence.calibrate = true;
-
-        err = adc_read(cfg->adc_channel.dev, &sequence);
+    if (!IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_FAST_BOOT)) {
+        err = kscan_ec_matrix_startup_calibration(dev);
         if (err < 0) {
-            LOG_ERR("Failed to calibrate on startup: %d", err);
             return err;
         }
     }
@@ -759,6 +2332,8 @@ static int kscan_ec_matrix_init(const struct device *dev) {
         gpio_pin_configure_dt(&cfg->drain, GPIO_OUTPUT_INACTIVE);
     }
 
+    data->drain_pulled_at = k_cycle_get_32();
+
     for (int i = 0; i < cfg->strobes_len; i++) {
         if (!device_is_ready(cfg->strobes[i].port)) {
             LOG_ERR("Strobe port is not ready");
@@ -777,7 +2352,29 @@ static int kscan_ec_matrix_init(const struct device *dev) {
         gpio_pin_configure_dt(&cfg->inputs[i], GPIO_DISCONNECTED);
     }
 
-    data->poll_interval = cfg->active_polling_interval_ms;
+    data->poll_interval_us = cfg->active_polling_interval_us;
+
+    // The scan timer period is rounded up to whole kernel ticks, e.g. 125us to about 152us with a
+    // 32768Hz tick, which the overrun count does not reveal.
+    uint32_t effective_interval_us =
+        k_ticks_to_us_near32(k_us_to_ticks_ceil32(cfg->active_polling_interval_us));
+    if (effective_interval_us != cfg->active_polling_interval_us) {
+        LOG_WRN("Polling interval of %uus rounds to %uus at the kernel tick rate, polling at %uHz",
+                cfg->active_polling_interval_us, effective_interval_us,
+                USEC_PER_SEC / effective_interval_us);
+    }
+
+    data->debounce_press_cycles = k_us_to_cyc_ceil32(cfg->debounce_press_us);
+    data->debounce_release_cycles = k_us_to_cyc_ceil32(cfg->debounce_release_us);
+    k_sem_init(&data->scan_sem, 0, 1);
+    k_timer_init(&data->scan_timer, kscan_ec_matrix_scan_timer_expiry, NULL);
+
+    data->input_order_len = kscan_ec_matrix_plan_order(cfg, cfg->inputs, cfg->inputs_len,
+                                                       input_unmasked, data->input_order);
+    data->strobe_order_len = kscan_ec_matrix_plan_order(cfg, cfg->strobes, cfg->strobes_len,
+                                                        strobe_unmasked, data->strobe_order);
+
+    kscan_ec_matrix_update_thresholds(dev);
 
     k_mutex_lock(&data->mutex, K_MSEC(5));
 
@@ -815,10 +2412,24 @@ static int zkem_pm_action(const struct device *dev, enum pm_device_action action
 
 #define ZKEM_GPIO_DT_SPEC_ELEM(n, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(n, prop, idx),
 
-#define ZERO(n, idx) 0
-
 #define ENTRIES(n) DT_INST_PROP_LEN(n, strobe_gpios) * DT_INST_PROP_LEN(n, input_gpios)
 
+// Words of the key bitsets, e.g. matrix_state, across all strobes.
+#define ROW_WORDS(n)                                                                               \
+    (DT_INST_PROP_LEN(n, strobe_gpios) *                                                           \
+     EC_MATRIX_BITSET_WORDS(DT_INST_PROP_LEN(n, input_gpios)))
+
+#define MASK_WORDS(n) DIV_ROUND_UP(DT_INST_PROP_LEN(n, input_gpios), 32)
+
+#define ZKEM_RAW_LINE(node_id, prop, idx)                                                          \
+    {                                                                                              \
+        .port = DEVICE_DT_GET(DT_GPIO_CTLR_BY_IDX(node_id, prop, idx)),                            \
+        .pins = BIT(DT_GPIO_PIN_BY_IDX(node_id, prop, idx)),                                       \
+        .active_low = (DT_GPIO_FLAGS_BY_IDX(node_id, prop, idx) & GPIO_ACTIVE_LOW) != 0,           \
+    }
+
+#define ZKEM_RAW_LINE_ELEM(node_id, prop, idx) ZKEM_RAW_LINE(node_id, prop, idx),
+
 #define FOREACH_STROBE_CALIB_ENTRY(n, prop, idx)                                                   \
     {.avg_low = DT_PROP_BY_IDX(n, precalib_avg_lows, idx),                                         \
      .avg_high = DT_PROP_BY_IDX(n, precalib_avg_highs, idx)}
@@ -831,21 +2442,76 @@ static int zkem_pm_action(const struct device *dev, enum pm_device_action action
                     (DT_INST_FOREACH_PROP_ELEM_SEP(n, precalib_avg_lows,                           \
                                                    FOREACH_STROBE_CALIB_ENTRY, (, ))),             \
                     (0))};                                                                         \
-    static uint64_t reported_matrix_states_##n[DT_INST_PROP_LEN(n, strobe_gpios)] = {0};           \
+    IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR,                                              \
+               (static struct zmk_kscan_ec_matrix_calibration_entry                                \
+                    calibration_shadow_##n[ENTRIES(n)];                                            \
+                static struct kscan_ec_matrix_calibration_key calibration_keys_##n[ENTRIES(n)];    \
+                static uint64_t calibration_pending_##n[ROW_WORDS(n)];))                           \
+    static struct kscan_ec_matrix_threshold thresholds_##n[ENTRIES(n)];                           \
+    IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE,                                                   \
+               (static struct zmk_kscan_ec_matrix_trace_record                                     \
+                    trace_records_##n[CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE_RING_SIZE];))               \
+    IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT,                                         \
+               (static uint16_t analog_frames_##n[2 * ENTRIES(n)];))                               \
+    static uint64_t active_inputs_##n[ROW_WORDS(n)];                                              \
+    static uint8_t input_order_##n[DT_INST_PROP_LEN(n, input_gpios)];                             \
+    static uint8_t strobe_order_##n[DT_INST_PROP_LEN(n, strobe_gpios)];                           \
+    static uint32_t debounce_states_##n[ENTRIES(n)];                                              \
+    IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING,                                       \
+               (static int32_t baselines_##n[ENTRIES(n)];))                                        \
+    IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER,                                           \
+               (static uint16_t rapid_extremums_##n[ENTRIES(n)];                                   \
+                static uint16_t rapid_extremums_before_##n[ENTRIES(n)];))                          \
+    static uint64_t debounce_unsettled_##n[ROW_WORDS(n)];                                         \
+    static uint64_t reported_matrix_states_##n[ROW_WORDS(n)];                                     \
+    static uint64_t matrix_states_##n[ROW_WORDS(n)];                                              \
     COND_CODE_1(                                                                                   \
         DT_INST_NODE_HAS_PROP(n, strobe_input_masks),                                              \
-        (static const uint32_t strobe_input_masks_##n[] = DT_INST_PROP(n, strobe_input_masks);),   \
+        (static const uint32_t strobe_input_masks_##n[] = DT_INST_PROP(n, strobe_input_masks);     \
+         BUILD_ASSERT(DT_INST_PROP_LEN(n, strobe_input_masks) ==                                   \
+                          DT_INST_PROP_LEN(n, strobe_gpios) * MASK_WORDS(n),                       \
+                      "strobe-input-masks needs one mask per 32 inputs of each strobe");),         \
         ())                                                                                        \
     static struct kscan_ec_matrix_data kscan_ec_matrix_data##n = {                                 \
         .reported_matrix_state = reported_matrix_states_##n,                                       \
         .calibrations = calibration_entries_##n,                                                   \
-        .matrix_state = {LISTIFY(DT_INST_PROP_LEN(n, strobe_gpios), ZERO, (, ))},                  \
+        IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_CALIBRATOR,                                          \
+                   (.calibration_shadow = calibration_shadow_##n,                                  \
+                    .calibration_keys = calibration_keys_##n,                                      \
+                    .calibration_pending = calibration_pending_##n, ))                             \
+        .thresholds = thresholds_##n,                                                              \
+        .active_inputs = active_inputs_##n,                                                        \
+        .input_order = input_order_##n,                                                            \
+        .strobe_order = strobe_order_##n,                                                          \
+        .debounce_states = debounce_states_##n,                                                    \
+        IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BASELINE_TRACKING, (.baselines = baselines_##n, ))   \
+        IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER,                                       \
+                   (.rapid_extremums = rapid_extremums_##n,                                        \
+                    .rapid_extremums_before = rapid_extremums_before_##n, ))                       \
+        .debounce_unsettled = debounce_unsettled_##n,                                              \
+        IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE, (.trace_records = trace_records_##n, ))       \
+        IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT,                                     \
+                   (.analog_frames = analog_frames_##n, ))                                         \
+        .matrix_state = matrix_states_##n,                                                         \
     };                                                                                             \
     static const struct gpio_dt_spec inputs_##n[] = {                                              \
         DT_FOREACH_PROP_ELEM(DT_DRV_INST(n), input_gpios, ZKEM_GPIO_DT_SPEC_ELEM)};                \
+    IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO,                                             \
+               (static const struct kscan_ec_matrix_raw_line raw_strobes_##n[] = {                 \
+                    DT_FOREACH_PROP_ELEM(DT_DRV_INST(n), strobe_gpios, ZKEM_RAW_LINE_ELEM)};))     \
     BUILD_ASSERT(DT_INST_PROP(n, trigger_percentage) > 10 &&                                       \
                      DT_INST_PROP(n, trigger_percentage) < 90,                                     \
                  "trigger-percentage must be between 10 and 95");                                  \
+    BUILD_ASSERT(DT_INST_PROP(n, debounce_window) <= 8 &&                                          \
+                     DT_INST_PROP(n, debounce_votes) <= DT_INST_PROP(n, debounce_window) &&        \
+                     DT_INST_PROP(n, debounce_votes) * 2 > DT_INST_PROP(n, debounce_window),       \
+                 "debounce-votes must be a majority of a debounce-window of at most 8");          \
+    IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_MODE_BATCHED,                                       \
+               (BUILD_ASSERT(DT_INST_PROP_OR(n, matrix_relax_us, 0) +                              \
+                                     DT_INST_PROP_OR(n, adc_read_settle_us, 0) <=                  \
+                                 CONFIG_ZMK_KSCAN_EC_MATRIX_BATCHED_MAX_STROBE_WAIT_US,            \
+                             "matrix-relax-us plus adc-read-settle-us exceeds the busy-wait "      \
+                             "allowed in the ADC interrupt by batched reads");))                   \
     static const struct kscan_ec_matrix_config kscan_ec_matrix_config##n = {                       \
         COND_CODE_1(DT_INST_NODE_HAS_PROP(n, pinctrl_names),                                       \
                     (.pcfg = PINCTRL_DT_INST_DEV_CONFIG_GET(n), ), ())                             \
@@ -856,14 +2522,35 @@ static int zkem_pm_action(const struct device *dev, enum pm_device_action action
         .strobes_len = DT_INST_PROP_LEN(n, strobe_gpios),                                          \
         .inputs = inputs_##n,                                                                      \
         .inputs_len = DT_INST_PROP_LEN(n, input_gpios),                                            \
+        .row_words = EC_MATRIX_BITSET_WORDS(DT_INST_PROP_LEN(n, input_gpios)),                     \
+        .mask_words = MASK_WORDS(n),                                                               \
         COND_CODE_1(DT_INST_NODE_HAS_PROP(n, strobe_input_masks),                                  \
                     (.strobe_input_masks = strobe_input_masks_##n, ), ())                          \
+        IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAW_PORT_IO,                                         \
+                   (.raw_strobes = raw_strobes_##n,                                                \
+                    .raw_drain = COND_CODE_1(DT_INST_NODE_HAS_PROP(n, drain_gpios),                \
+                                             (ZKEM_RAW_LINE(DT_DRV_INST(n), drain_gpios, 0)),      \
+                                             ({0})), ))                                            \
             .matrix_warm_up_us = DT_INST_PROP_OR(n, matrix_warm_up_us, 0),                         \
         .matrix_relax_us = DT_INST_PROP_OR(n, matrix_relax_us, 0),                                 \
         .adc_read_settle_us = DT_INST_PROP_OR(n, adc_read_settle_us, 0),                           \
-        .active_polling_interval_ms = DT_INST_PROP_OR(n, active_polling_interval_ms, 1),           \
+        .active_polling_interval_us =                                                              \
+            DT_INST_PROP_OR(n, active_polling_interval_us,                                         \
+                            DT_INST_PROP_OR(n, active_polling_interval_ms, 1) * 1000),             \
         .skip_startup_calibration = DT_INST_PROP_OR(n, skip_startup_calibration, false),           \
         .trigger_percentage = DT_INST_PROP_OR(n, trigger_percentage, 50),                          \
+        .confirm_reads = DT_INST_PROP_OR(n, confirm_reads, 0),                                     \
+        .debounce_policy = DT_INST_ENUM_IDX_OR(n, debounce_policy, DEBOUNCE_POLICY_TWO_SCAN),      \
+        .debounce_votes = DT_INST_PROP(n, debounce_votes),                                         \
+        .debounce_window = DT_INST_PROP(n, debounce_window),                                       \
+        .debounce_press_us = DT_INST_PROP(n, debounce_press_us),                                   \
+        .debounce_release_us = DT_INST_PROP(n, debounce_release_us),                               \
+        IF_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_RAPID_TRIGGER,                                       \
+                   (.rapid_trigger = DT_INST_PROP(n, rapid_trigger),                               \
+                    .rapid_trigger_press_percentage =                                              \
+                        DT_INST_PROP(n, rapid_trigger_press_percentage),                           \
+                    .rapid_trigger_release_percentage =                                            \
+                        DT_INST_PROP(n, rapid_trigger_release_percentage), ))                      \
         COND_CODE_1(                                                                               \
             IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_DYNAMIC_POLL_RATE),                              \
             (.idle_polling_interval_ms = DT_INST_PROP_OR(n, idle_polling_interval_ms, 5),          \
@@ -8,6 +8,9 @@ struct zmk_kscan_ec_matrix_calibration_event {
         CALIBRATION_EV_POSITION_LOW_DETERMINED,
         CALIBRATION_EV_POSITION_COMPLETE,
         CALIBRATION_EV_COMPLETE,
+        CALIBRATION_EV_POSITION_TIMEOUT,
+        CALIBRATION_EV_POSITION_SKIPPED,
+        CALIBRATION_EV_PROGRESS,
     } type;
 
     union zmk_kscan_ec_matrix_calibration_event_data {
@@ -28,6 +31,15 @@ struct zmk_kscan_ec_matrix_calibration_event {
             int16_t noise;
             int16_t snr;
         } position_complete;
+        // Data of both CALIBRATION_EV_POSITION_TIMEOUT and CALIBRATION_EV_POSITION_SKIPPED.
+        struct {
+            uint8_t strobe;
+            uint8_t input;
+        } position_skipped;
+        struct {
+            uint16_t completed;
+            uint16_t total;
+        } progress;
 
         struct {
 
@@ -35,25 +47,58 @@ struct zmk_kscan_ec_matrix_calibration_event {
     } data;
 };
 
+// Fraction bits of zmk_kscan_ec_matrix_calibration_entry.noise_sigma.
+#define ZMK_KSCAN_EC_MATRIX_NOISE_SIGMA_FRACTION_BITS 4
+
 struct zmk_kscan_ec_matrix_calibration_entry {
     uint16_t avg_low;
     uint16_t avg_high;
+    // Peak to peak noise.
     uint16_t noise;
+    // Standard deviation of the noise, or 0 for calibrations made before it was measured.
+    uint16_t noise_sigma;
 };
 
+// Size of the entries saved before noise_sigma was added.
+#define ZMK_KSCAN_EC_MATRIX_CALIBRATION_ENTRY_LEGACY_SIZE                                          \
+    offsetof(struct zmk_kscan_ec_matrix_calibration_entry, noise_sigma)
+
 typedef void (*zmk_kscan_ec_matrix_calibration_cb_t)(const struct zmk_kscan_ec_matrix_calibration_event *ev, const void *);
-typedef void (*zmk_kscan_ec_matrix_calibration_access_cb_t)(const struct device *dev, struct zmk_kscan_ec_matrix_calibration_entry *entries, size_t len, const void *user_data);
+// Returns whether the entries were modified, so read-only accesses leave the key state alone.
+typedef bool (*zmk_kscan_ec_matrix_calibration_access_cb_t)(const struct device *dev, struct zmk_kscan_ec_matrix_calibration_entry *entries, size_t len, const void *user_data);
 
 int zmk_kscan_ec_matrix_calibrate(const struct device *dev, zmk_kscan_ec_matrix_calibration_cb_t cb, const void *user_data);
 
+struct zmk_kscan_ec_matrix_position {
+    uint8_t strobe;
+    uint8_t input;
+};
+
+// Recalibrates only the given positions, leaving the entries of every other position untouched.
+int zmk_kscan_ec_matrix_calibrate_positions(const struct device *dev, const struct zmk_kscan_ec_matrix_position *positions, size_t len, zmk_kscan_ec_matrix_calibration_cb_t cb, const void *user_data);
+
+// Stops waiting for one key of the calibration in progress, which keeps its previous calibration.
+int zmk_kscan_ec_matrix_calibration_skip(const struct device *dev, uint8_t strobe, uint8_t input);
+
+int zmk_kscan_ec_matrix_calibration_skip_remaining(const struct device *dev);
+
 int zmk_kscan_ec_matrix_access_calibration(const struct device *dev, zmk_kscan_ec_matrix_calibration_access_cb_t cb, const void *user_data);
 
+// Like zmk_kscan_ec_matrix_access_calibration(), but waits at most timeout for the scan lock,
+// which is held while the matrix is disabled. Returns -EAGAIN if it could not be taken.
+int zmk_kscan_ec_matrix_try_access_calibration(const struct device *dev, zmk_kscan_ec_matrix_calibration_access_cb_t cb, const void *user_data, k_timeout_t timeout);
+
+// Copies the calibration out, holding the scan lock only for the copy.
+int zmk_kscan_ec_matrix_copy_calibration(const struct device *dev, struct zmk_kscan_ec_matrix_calibration_entry *entries, size_t len);
+
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
 
 uint64_t zmk_kscan_ec_matrix_max_scan_duration_ns(const struct device *dev);
 
 #endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_SCAN_RATE_CALC)
 
+uint32_t zmk_kscan_ec_matrix_scan_overruns(const struct device *dev);
+
 #if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
 
 struct zmk_kscan_ec_matrix_read_timing {
@@ -68,8 +113,84 @@ struct zmk_kscan_ec_matrix_read_timing {
     uint64_t unset_strobe_ns;
     uint64_t pull_drain_ns;
     uint64_t input_disconnect_ns;
+    // Longest window with interrupts locked during the last scan, across all of its reads.
+    uint64_t irq_locked_max_ns;
+    // Relax time of the last scan already elapsed since the previous read, so not busy-waited.
+    uint64_t relax_saved_ns;
 };
 
 struct zmk_kscan_ec_matrix_read_timing zmk_kscan_ec_matrix_read_timing(const struct device *dev);
 
-#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
\ No newline at end of file
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_READ_TIMING)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+
+// Uptime in us at which each step of bringing the matrix up happened, or 0 if it has not yet.
+struct zmk_kscan_ec_matrix_boot_timing {
+    uint32_t adc_calibrated_us;
+    uint32_t first_scan_us;
+    uint32_t calibration_loaded_us;
+    // Set instead of calibration_loaded_us when settings held no calibration to load.
+    uint32_t calibration_absent_us;
+};
+
+struct zmk_kscan_ec_matrix_boot_timing zmk_kscan_ec_matrix_boot_timing(const struct device *dev);
+
+// Records that the stored calibration is in use, called by whatever loaded it at boot.
+void zmk_kscan_ec_matrix_boot_timing_calibration_loaded(const struct device *dev);
+
+// Records that there was no stored calibration to load, so scanning stays on the seed.
+void zmk_kscan_ec_matrix_boot_timing_calibration_absent(const struct device *dev);
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_BOOT_TIMING)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+
+#define ZMK_KSCAN_EC_MATRIX_TRACE_UP 0
+#define ZMK_KSCAN_EC_MATRIX_TRACE_DOWN BIT(0)
+#define ZMK_KSCAN_EC_MATRIX_TRACE_CHANGED BIT(1)
+// Recorded for a confirmation re-read that undid the change recorded earlier in the same scan.
+#define ZMK_KSCAN_EC_MATRIX_TRACE_REJECTED BIT(2)
+
+struct zmk_kscan_ec_matrix_trace_record {
+    uint32_t timestamp;
+    uint16_t raw;
+    uint16_t normalized;
+    uint8_t strobe;
+    uint8_t input;
+    uint8_t decision;
+};
+
+size_t zmk_kscan_ec_matrix_trace_drain(const struct device *dev,
+                                       struct zmk_kscan_ec_matrix_trace_record *records,
+                                       size_t max);
+
+uint32_t zmk_kscan_ec_matrix_trace_dropped(const struct device *dev);
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_TRACE)
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
+
+struct zmk_kscan_ec_matrix_analog_frame {
+    // Travel of each key from 0 (released) to UINT16_MAX (fully pressed), indexed by
+    // (strobe * inputs_len) + input. Masked and uncalibrated keys read as 0.
+    const uint16_t *travel;
+    uint32_t sequence;
+    uint8_t strobes_len;
+    uint8_t inputs_len;
+};
+
+/**
+ * Get the most recently published analog frame without copying it. The frame stays intact at
+ * least until the scan after next completes; check zmk_kscan_ec_matrix_analog_frame_valid()
+ * after reading to detect a frame that was overwritten while in use.
+ *
+ * @return 0 on success, -EAGAIN if no scan has completed yet.
+ */
+int zmk_kscan_ec_matrix_analog_frame_get(const struct device *dev,
+                                         struct zmk_kscan_ec_matrix_analog_frame *frame);
+
+bool zmk_kscan_ec_matrix_analog_frame_valid(const struct device *dev,
+                                            const struct zmk_kscan_ec_matrix_analog_frame *frame);
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_EC_MATRIX_ANALOG_SNAPSHOT)
\ No newline at end of file